@@ -0,0 +1,583 @@
+// boids_bench.c
+// Microbenchmarks + scaling regression check for the simulation kernels.
+//
+// Times each SysBoidsUpdate phase in isolation (grid build, neighbor
+// accumulation, integration), with the grid rebuilt every frame and kept
+// incrementally ("/incr" cases, where grid build times the per-frame cell
+// migration), and the ECS entry points
+// (registerComponent, addComponentToElement, getComponent, deferred commands)
+// across boid counts, spatial distributions and OpenMP thread counts. Results
+// are written as JSON; with --baseline the run fails (exit 1) if any case got
+// slower than the stored median by more than --threshold, and exits 2 when
+// there is nothing to compare against (missing baseline, or no case in
+// common).
+//   record once per machine with --out baseline.json
+//
+//   boids_bench [--quick] [--counts 1000,10000] [--threads 1,8]
+//               [--dist uniform,clustered] [--out results.json]
+//               [--baseline baseline.json] [--threshold 0.10]
+
+#define _POSIX_C_SOURCE 200809L
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "engine.h"
+#include "engine_components.h"
+#include "game.h"
+#include "raylib.h"
+#include "systems/systems.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_LIST 16
+#define BENCH_MAX_RESULTS 1024
+#define BENCH_MAX_SAMPLES 64
+#define BENCH_NAME_LEN 96
+#define BENCH_REORDER_REPS 5 // each one needs a freshly spawned world
+// A case also has to be this much slower in absolute terms to count as a
+// regression; microsecond cases would otherwise fail on timer jitter alone
+#define BENCH_MIN_DELTA_MS 0.005
+// Bumped when timings stop being comparable with older baselines (2: the
+// kernels walk [0, em.count) instead of all MAX_ENTITIES slots; 3: "/incr"
+// grid_build times the cell migration)
+#define BENCH_SCHEMA 3
+
+typedef enum { DIST_UNIFORM = 0, DIST_CLUSTERED } BenchDist_t;
+static const char *kDistNames[] = {"uniform", "clustered"};
+
+typedef struct {
+  char name[BENCH_NAME_LEN];
+  double medianMs;
+  double nsPerItem;
+  int samples;
+} BenchResult_t;
+
+typedef struct {
+  int counts[BENCH_MAX_LIST];
+  int countN;
+  int threads[BENCH_MAX_LIST];
+  int threadN;
+  int dists[2];
+  int distN;
+  double targetSeconds; // per case
+  const char *outPath;
+  const char *baselinePath;
+  double threshold;
+} BenchOptions_t;
+
+static BenchResult_t g_results[BENCH_MAX_RESULTS];
+static int g_resultCount = 0;
+
+// ------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------
+static double nowMs(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec * 1e3 + (double)t.tv_nsec * 1e-6;
+}
+
+// Deterministic xorshift so every run benches the same layout
+static uint32_t g_rng = 0x9E3779B9u;
+static float rnd01(void) {
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return (float)(g_rng & 0xFFFFFF) / (float)0x1000000;
+}
+static float rndNormal(void) {
+  float u = fmaxf(rnd01(), 1e-7f), v = rnd01();
+  return sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * v);
+}
+
+static int cmpDouble(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double median(double *s, int n) {
+  qsort(s, (size_t)n, sizeof(double), cmpDouble);
+  return (n & 1) ? s[n / 2] : 0.5 * (s[n / 2 - 1] + s[n / 2]);
+}
+
+static void record(const char *name, double *samples, int n, int items) {
+  if (g_resultCount >= BENCH_MAX_RESULTS || n == 0)
+    return;
+  BenchResult_t *r = &g_results[g_resultCount++];
+  snprintf(r->name, sizeof(r->name), "%s", name);
+  r->medianMs = median(samples, n);
+  r->nsPerItem = items > 0 ? r->medianMs * 1e6 / (double)items : 0.0;
+  r->samples = n;
+  printf("  %-52s %10.3f ms %9.2f ns/item (%d runs)\n", r->name, r->medianMs,
+         r->nsPerItem, n);
+  fflush(stdout);
+}
+
+static int parseList(const char *s, int *out, int max) {
+  int n = 0;
+  while (*s && n < max) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s)
+      break;
+    out[n++] = (int)v;
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return n;
+}
+
+// ------------------------------------------------------------
+// World setup
+// ------------------------------------------------------------
+typedef struct {
+  Engine_t *eng;
+  GameState_t *gs;
+} BenchWorld_t;
+
+static bool worldCreate(BenchWorld_t *w) {
+  EngineConfig_t cfg = {0};
+  cfg.headless = true;
+  cfg.huge_pages = true;
+  cfg.no_terrain = true;
+
+  w->eng = calloc(1, sizeof(Engine_t));
+  w->gs = calloc(1, sizeof(GameState_t));
+  if (!w->eng || !w->gs)
+    return false;
+  engine_init(w->eng, &cfg);
+  GameSetDefaultParams(w->gs);
+  return true;
+}
+
+static void worldDestroy(BenchWorld_t *w) {
+  engine_shutdown();
+  free(w->eng);
+  free(w->gs);
+}
+
+// Spawns `count` boids. Bounds grow with the count so uniform density stays
+// at the demo's 5000 boids per 100^3 box; clustered packs them into blobs.
+static void worldSpawn(BenchWorld_t *w, int count, BenchDist_t dist) {
+  Engine_t *eng = w->eng;
+  GameState_t *gs = w->gs;
+
+  float half = 50.0f * cbrtf((float)count / 5000.0f);
+  gs->boundsMin = (Vector3){-half, -half, -half};
+  gs->boundsMax = (Vector3){half, half, half};
+
+  gs->reg.cid_pos = registerComponent(eng->actors, sizeof(Vector3));
+  gs->reg.cid_vel = registerComponent(eng->actors, sizeof(Vector3));
+
+  g_rng = 0x9E3779B9u;
+  enum { CLUSTERS = 16 };
+  Vector3 centers[CLUSTERS];
+  for (int c = 0; c < CLUSTERS; c++)
+    centers[c] = (Vector3){(rnd01() * 1.6f - 0.8f) * half,
+                           (rnd01() * 1.6f - 0.8f) * half,
+                           (rnd01() * 1.6f - 0.8f) * half};
+
+  gs->boidCount = 0;
+  for (int i = 0; i < count; i++) {
+    entity_t e = spawnEntity(&eng->em, ET_ACTOR);
+    if (e == ENTITY_INVALID)
+      break;
+    gs->boids[gs->boidCount++] = e;
+
+    Vector3 p;
+    if (dist == DIST_UNIFORM) {
+      p = (Vector3){(rnd01() * 2.0f - 1.0f) * half,
+                    (rnd01() * 2.0f - 1.0f) * half,
+                    (rnd01() * 2.0f - 1.0f) * half};
+    } else {
+      Vector3 c = centers[i % CLUSTERS];
+      float sigma = half * 0.05f;
+      p = (Vector3){fminf(fmaxf(c.x + rndNormal() * sigma, -half), half),
+                    fminf(fmaxf(c.y + rndNormal() * sigma, -half), half),
+                    fminf(fmaxf(c.z + rndNormal() * sigma, -half), half)};
+    }
+    Vector3 v = {(rnd01() * 2.0f - 1.0f) * 5.0f, (rnd01() * 2.0f - 1.0f) * 5.0f,
+                 (rnd01() * 2.0f - 1.0f) * 5.0f};
+
+    addComponentToElement(&eng->em, eng->actors, e, gs->reg.cid_pos, &p);
+    addComponentToElement(&eng->em, eng->actors, e, gs->reg.cid_vel, &v);
+  }
+}
+
+// ------------------------------------------------------------
+// Cases
+// ------------------------------------------------------------
+static int repsFor(double firstMs, double targetSeconds) {
+  int reps = firstMs > 0.0 ? (int)(targetSeconds * 1e3 / firstMs) : 1;
+  if (reps < 3)
+    reps = 3;
+  if (reps > BENCH_MAX_SAMPLES)
+    reps = BENCH_MAX_SAMPLES;
+  return reps;
+}
+
+static void benchPhases(const BenchOptions_t *o, int count, BenchDist_t dist,
+                        int threads, bool incremental) {
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  BenchWorld_t w;
+  if (!worldCreate(&w))
+    return;
+  worldSpawn(&w, count, dist);
+  w.gs->gridIncremental = incremental;
+
+  const float dt = 1.0f / 60.0f;
+  double tGrid[BENCH_MAX_SAMPLES], tAcc[BENCH_MAX_SAMPLES],
+      tInt[BENCH_MAX_SAMPLES], tAll[BENCH_MAX_SAMPLES];
+
+  // Warm-up step (first touch of scratch pages, thread pool spin-up)
+  engine_begin_frame(w.eng);
+  double warm0 = nowMs();
+  SysBoidsUpdate(w.gs, w.eng, dt);
+  int reps = repsFor(nowMs() - warm0, o->targetSeconds / 4.0);
+
+  // Time the phases on Morton-ordered storage, as the game runs them
+  reorderComponentsMorton(&w.eng->em, w.eng->actors, w.gs->reg.cid_pos,
+                          w.gs->boundsMin, w.gs->boundsMax, &w.eng->frame);
+
+  for (int r = 0; r < reps; r++) {
+    engine_begin_frame(w.eng);
+    BoidsFrame_t f;
+    if (!BoidsFrameBegin(&f, w.gs, w.eng)) {
+      reps = r;
+      break;
+    }
+
+    // grid_build is the grid's cost per frame: the full rebuild, or in
+    // incremental mode (where the build is a no-op) the relinking of boids
+    // that integrate moved into another cell
+    double t0 = nowMs();
+    BoidsGridBuild(&f, w.eng);
+    double t1 = nowMs();
+    BoidsAccumulate(&f, w.gs, w.eng, dt);
+    double t2 = nowMs();
+    BoidsIntegrate(&f, w.gs, w.eng, dt);
+    double t3 = nowMs();
+    BoidsGridMigrate(&f);
+    double t4 = nowMs();
+    BoidsFrameEnd(&f);
+
+    tGrid[r] = (t1 - t0) + (t4 - t3);
+    tAcc[r] = t2 - t1;
+    tInt[r] = t3 - t2;
+    tAll[r] = t4 - t0;
+  }
+
+  char name[BENCH_NAME_LEN];
+  const char *dn = kDistNames[dist];
+  const char *gm = incremental ? "/incr" : "";
+  snprintf(name, sizeof(name), "grid_build/%s/n=%d/t=%d%s", dn, count, threads,
+           gm);
+  record(name, tGrid, reps, count);
+  snprintf(name, sizeof(name), "accumulate/%s/n=%d/t=%d%s", dn, count, threads,
+           gm);
+  record(name, tAcc, reps, count);
+  snprintf(name, sizeof(name), "integrate/%s/n=%d/t=%d%s", dn, count, threads,
+           gm);
+  record(name, tInt, reps, count);
+  snprintf(name, sizeof(name), "update/%s/n=%d/t=%d%s", dn, count, threads, gm);
+  record(name, tAll, reps, count);
+
+  worldDestroy(&w);
+}
+
+// The first sort after spawning is the worst case (every slot moves) and
+// cannot be repeated on the same world, so every sample spawns a new one. The
+// spawn is seeded, so each sample sorts the same input.
+static void benchReorder(int count, BenchDist_t dist, int threads) {
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif
+
+  double tSort[BENCH_REORDER_REPS];
+  int reps = 0;
+  for (int r = 0; r < BENCH_REORDER_REPS; r++) {
+    BenchWorld_t w;
+    if (!worldCreate(&w))
+      break;
+    worldSpawn(&w, count, dist);
+    engine_begin_frame(w.eng);
+
+    double t0 = nowMs();
+    bool ok = reorderComponentsMorton(&w.eng->em, w.eng->actors,
+                                      w.gs->reg.cid_pos, w.gs->boundsMin,
+                                      w.gs->boundsMax, &w.eng->frame);
+    tSort[r] = nowMs() - t0;
+    worldDestroy(&w);
+    if (!ok)
+      break;
+    reps++;
+  }
+
+  char name[BENCH_NAME_LEN];
+  snprintf(name, sizeof(name), "reorder/%s/n=%d/t=%d", kDistNames[dist], count,
+           threads);
+  record(name, tSort, reps, count);
+}
+
+static void benchEcs(const BenchOptions_t *o, int count) {
+  (void)o;
+  double tReg[BENCH_MAX_SAMPLES], tAdd[BENCH_MAX_SAMPLES],
+      tGet[BENCH_MAX_SAMPLES], tCmd[BENCH_MAX_SAMPLES];
+  int reps = 5;
+
+  int *order = malloc(sizeof(int) * (size_t)count);
+  if (!order)
+    return;
+  for (int i = 0; i < count; i++)
+    order[i] = i;
+  for (int i = count - 1; i > 0; i--) { // shuffled lookups
+    int j = (int)(rnd01() * (float)(i + 1));
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  volatile float sink = 0.0f;
+  for (int r = 0; r < reps; r++) {
+    BenchWorld_t w;
+    if (!worldCreate(&w))
+      break;
+    Engine_t *eng = w.eng;
+
+    double t0 = nowMs();
+    int cid = registerComponent(eng->actors, sizeof(Vector3));
+    tReg[r] = nowMs() - t0;
+
+    for (int i = 0; i < count; i++)
+      spawnEntity(&eng->em, ET_ACTOR);
+
+    Vector3 v = {1, 2, 3};
+    t0 = nowMs();
+    for (int i = 0; i < count; i++)
+      addComponentToElement(&eng->em, eng->actors, MakeEntityID(ET_ACTOR, i),
+                            cid, &v);
+    tAdd[r] = nowMs() - t0;
+
+    t0 = nowMs();
+    float acc = 0.0f;
+    for (int i = 0; i < count; i++) {
+      Vector3 *p =
+          getComponent(eng->actors, MakeEntityID(ET_ACTOR, order[i]), cid);
+      acc += p->x;
+    }
+    tGet[r] = nowMs() - t0;
+    sink += acc;
+
+    // Deferred: threads record kills, flush; then spawns that reuse those
+    // handles plus a component each, flush
+    int cid2 = registerComponent(eng->actors, sizeof(Vector3));
+    t0 = nowMs();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < count; i++)
+      commands_kill(eng->commands, MakeEntityID(ET_ACTOR, i));
+    engine_flush_commands(eng);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < count; i++) {
+      entity_t e = commands_spawn(eng->commands, ET_ACTOR);
+      commands_add(eng->commands, e, cid2, &v, sizeof(v));
+    }
+    engine_flush_commands(eng);
+    tCmd[r] = nowMs() - t0;
+
+    worldDestroy(&w);
+  }
+  (void)sink;
+  free(order);
+
+  char name[BENCH_NAME_LEN];
+  snprintf(name, sizeof(name), "ecs_register/n=%d", count);
+  record(name, tReg, reps, 1);
+  snprintf(name, sizeof(name), "ecs_add/n=%d", count);
+  record(name, tAdd, reps, count);
+  snprintf(name, sizeof(name), "ecs_get_random/n=%d", count);
+  record(name, tGet, reps, count);
+  snprintf(name, sizeof(name), "ecs_deferred/n=%d", count);
+  record(name, tCmd, reps, count);
+}
+
+// ------------------------------------------------------------
+// JSON out / baseline compare
+// ------------------------------------------------------------
+static bool writeJson(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fprintf(f, "{\n  \"schema\": %d,\n  \"max_entities\": %d,\n",
+          BENCH_SCHEMA, MAX_ENTITIES);
+  fprintf(f, "  \"results\": [\n");
+  for (int i = 0; i < g_resultCount; i++) {
+    const BenchResult_t *r = &g_results[i];
+    fprintf(f,
+            "    {\"name\": \"%s\", \"median_ms\": %.6f, \"ns_per_item\": "
+            "%.4f, \"samples\": %d}%s\n",
+            r->name, r->medianMs, r->nsPerItem, r->samples,
+            i + 1 < g_resultCount ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+  return true;
+}
+
+// Reads back the format writeJson produces (one result object per line).
+// Number of regressions, or -1 when nothing could be compared.
+static int compareBaseline(const char *path, double threshold) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr,
+            "baseline %s not found; record one on this machine with "
+            "--out %s\n",
+            path, path);
+    return -1;
+  }
+
+  int regressions = 0, compared = 0;
+  char line[512];
+  printf("\ncomparison against %s (threshold +%.0f%%)\n", path,
+         threshold * 100.0);
+  while (fgets(line, sizeof(line), f)) {
+    char *sc = strstr(line, "\"schema\": ");
+    if (sc && atoi(sc + 10) != BENCH_SCHEMA) {
+      fprintf(stderr,
+              "baseline %s is schema %d, this build writes %d; record it "
+              "again with --out %s\n",
+              path, atoi(sc + 10), BENCH_SCHEMA, path);
+      fclose(f);
+      return -1;
+    }
+    char *n = strstr(line, "\"name\": \"");
+    char *m = strstr(line, "\"median_ms\": ");
+    if (!n || !m)
+      continue;
+    n += 9;
+    char *q = strchr(n, '"');
+    if (!q)
+      continue;
+    *q = '\0';
+    double base = strtod(m + 13, NULL);
+
+    for (int i = 0; i < g_resultCount; i++) {
+      if (strcmp(g_results[i].name, n) != 0)
+        continue;
+      double cur = g_results[i].medianMs;
+      double ratio = base > 0.0 ? cur / base : 1.0;
+      bool bad = ratio > 1.0 + threshold && cur - base > BENCH_MIN_DELTA_MS;
+      compared++;
+      regressions += bad;
+      printf("  %-52s %10.3f -> %10.3f ms  %+6.1f%%%s\n", n, base, cur,
+             (ratio - 1.0) * 100.0, bad ? "  REGRESSION" : "");
+    }
+  }
+  fclose(f);
+
+  printf("%d case(s) compared, %d regression(s)\n", compared, regressions);
+  if (compared == 0) {
+    fprintf(stderr, "baseline %s has no case in common with this run\n",
+            path);
+    return -1;
+  }
+  return regressions;
+}
+
+// ------------------------------------------------------------
+// main
+// ------------------------------------------------------------
+int main(int argc, char **argv) {
+  BenchOptions_t o = {0};
+  o.counts[0] = 1000;
+  o.counts[1] = 10000;
+  o.counts[2] = 100000;
+  o.counts[3] = 1000000;
+  o.countN = 4;
+  o.dists[0] = DIST_UNIFORM;
+  o.dists[1] = DIST_CLUSTERED;
+  o.distN = 2;
+  o.targetSeconds = 2.0;
+  o.outPath = "bench_results.json";
+  o.threshold = 0.10;
+
+  int maxThreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  for (int t = 1; t < maxThreads && o.threadN < BENCH_MAX_LIST - 1; t *= 2)
+    o.threads[o.threadN++] = t;
+  o.threads[o.threadN++] = maxThreads;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      o.countN = 3;
+      o.targetSeconds = 0.5;
+    } else if (strcmp(argv[i], "--counts") == 0 && i + 1 < argc)
+      o.countN = parseList(argv[++i], o.counts, BENCH_MAX_LIST);
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      o.threadN = parseList(argv[++i], o.threads, BENCH_MAX_LIST);
+    else if (strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+      const char *d = argv[++i];
+      o.distN = 0;
+      if (strstr(d, "uniform"))
+        o.dists[o.distN++] = DIST_UNIFORM;
+      if (strstr(d, "clustered"))
+        o.dists[o.distN++] = DIST_CLUSTERED;
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+      o.outPath = argv[++i];
+    else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+      o.baselinePath = argv[++i];
+    else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+      o.threshold = atof(argv[++i]);
+    else {
+      fprintf(stderr, "unknown argument: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  SetTraceLogLevel(LOG_WARNING);
+  printf("boids_bench: MAX_ENTITIES=%d, up to %d threads\n", MAX_ENTITIES,
+         maxThreads);
+
+  for (int c = 0; c < o.countN; c++) {
+    int n = o.counts[c];
+    if (n > MAX_ENTITIES) {
+      printf("skipping n=%d (> MAX_ENTITIES)\n", n);
+      continue;
+    }
+    printf("n=%d\n", n);
+    benchEcs(&o, n);
+    for (int d = 0; d < o.distN; d++)
+      for (int t = 0; t < o.threadN; t++) {
+        benchReorder(n, (BenchDist_t)o.dists[d], o.threads[t]);
+        for (int g = 0; g < 2; g++)
+          benchPhases(&o, n, (BenchDist_t)o.dists[d], o.threads[t], g == 1);
+      }
+  }
+
+  if (!writeJson(o.outPath)) {
+    fprintf(stderr, "cannot write %s\n", o.outPath);
+    return 2;
+  }
+  printf("wrote %d results to %s\n", g_resultCount, o.outPath);
+
+  if (o.baselinePath) {
+    int regressions = compareBaseline(o.baselinePath, o.threshold);
+    if (regressions < 0)
+      return 2;
+    if (regressions > 0)
+      return 1;
+  }
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include "engine.h"
+#include "engine_arena.h"
 #include "engine_components.h"
 #include "raylib.h"
 #include <stdlib.h>
@@ -9,33 +10,109 @@ static Engine_t *g_engine = NULL;
 
 Engine_t *engine_get(void) { return g_engine; }
 
+// Halves the reservation until the kernel grants it (strict overcommit
+// counts the whole range against the commit limit)
+static bool reserveArena(Arena_t *a, const char *name, size_t reserve,
+                         bool hugePages) {
+  for (;;) {
+    if (arena_init(a, name, reserve, hugePages))
+      return true;
+    if (reserve / 2 < ENGINE_MIN_RESERVE)
+      return false;
+    reserve /= 2;
+    TraceLog(LOG_WARNING, "ENGINE: [%s] retrying with %.0f MiB", name,
+             (double)reserve / (1024.0 * 1024.0));
+  }
+}
+
 void engine_init(struct Engine *eng, const struct EngineConfig *cfg) {
   g_engine = eng;
   g_engine->config = *cfg;
 
-  SetConfigFlags(FLAG_VSYNC_HINT);
+  if (!cfg->headless) {
+    SetConfigFlags(FLAG_VSYNC_HINT);
 
-  InitWindow(cfg->window_width, cfg->window_height, "Blubber NGN");
+    InitWindow(cfg->window_width, cfg->window_height, "Blubber NGN");
+  }
 
   eng->em.count = 0;
   memset(eng->em.alive, 0, sizeof(eng->em.alive));
   memset(eng->em.masks, 0, sizeof(eng->em.masks));
+  // No handle issued yet: everything resolves to "no slot"
+  for (int i = 0; i < MAX_ENTITIES; i++) {
+    eng->em.slotOf[i] = -1;
+    eng->em.handleOf[i] = -1;
+  }
+  eng->em.layoutVersion = 0;
+  eng->em.handleCount = 0;
+  eng->em.freeCount = 0;
 
-  eng->actors = malloc(sizeof(ActorComponents_t));
-  memset(eng->actors, 0, sizeof(ActorComponents_t));
   memset(&eng->projectiles, 0, sizeof(eng->projectiles));
   memset(&eng->statics, 0, sizeof(eng->statics));
   memset(&eng->particles, 0, sizeof(eng->particles));
 
-  eng->actors = malloc(sizeof(ActorComponents_t));
-  memset(eng->actors, 0, sizeof(ActorComponents_t));
+  // Every long-lived allocation comes out of the persistent arena
+  if (!reserveArena(&eng->persistent, "persistent", ENGINE_PERSISTENT_RESERVE,
+                    cfg->huge_pages) ||
+      !reserveArena(&eng->frame, "frame", ENGINE_FRAME_RESERVE,
+                    cfg->huge_pages)) {
+    TraceLog(LOG_FATAL, "ENGINE: cannot reserve arenas");
+    exit(1);
+  }
 
-  eng->actors->componentStore =
-      calloc(MAX_COMPONENTS, sizeof(ComponentStorage_t));
+  // reserveArena may have settled for less than asked, so these can fail too
+  eng->actors = arena_alloc(&eng->persistent, sizeof(ActorComponents_t), 0);
+  if (eng->actors)
+    eng->actors->componentStore = arena_alloc(
+        &eng->persistent, MAX_COMPONENTS * sizeof(ComponentStorage_t), 0);
+  eng->commands = arena_alloc(&eng->persistent, sizeof(EntityCommands_t), 0);
+  if (!eng->actors || !eng->actors->componentStore || !eng->commands) {
+    TraceLog(LOG_FATAL, "ENGINE: persistent arena too small for ECS tables");
+    exit(1);
+  }
+
+  eng->actors->arena = &eng->persistent;
   eng->actors->componentCount = 0;
+  eng->actors->slotOf = eng->em.slotOf;
+  commands_init(eng->commands);
+}
+
+void engine_begin_frame(Engine_t *eng) { arena_reset(&eng->frame); }
+
+int engine_flush_commands(Engine_t *eng) {
+  return commands_flush(eng->commands, &eng->em, eng->actors);
+}
+
+void engine_report_memory(const Engine_t *eng) {
+  arena_report(&eng->persistent);
+  arena_report(&eng->frame);
+
+  const ActorComponents_t *ac = eng->actors;
+  for (int c = 0; ac && c < ac->componentCount; c++) {
+    const ComponentStorage_t *cs = &ac->componentStore[c];
+    TraceLog(LOG_INFO, "ARENA:   component %d: %zu B x %d = %.2f MiB, %d used",
+             c, cs->elementSize, MAX_ENTITIES,
+             (double)(cs->elementSize * MAX_ENTITIES) / (1024.0 * 1024.0),
+             cs->count);
+  }
 }
 
 void engine_shutdown(void) {
-  CloseWindow();
+  if (!g_engine)
+    return;
+
+  engine_report_memory(g_engine);
+
+  // Command buffers grow with malloc (recorded from any thread)
+  commands_destroy(g_engine->commands);
+  g_engine->commands = NULL;
+
+  // Columns and tables all live in the arenas: two unmaps free everything
+  g_engine->actors = NULL;
+  arena_destroy(&g_engine->frame);
+  arena_destroy(&g_engine->persistent);
+
+  if (!g_engine->config.headless)
+    CloseWindow();
   g_engine = NULL;
 }
@@ -1,10 +1,33 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include "engine_arena.h"
+#include "engine_commands.h"
 #include "engine_components.h"
 #include <stdbool.h>
 #include <stdint.h>
 
+// Virtual reservations; pages are committed on first touch. Sized from the
+// entity and component limits so a strict-overcommit system can still grant
+// them: every component column at up to ENGINE_COMPONENT_BYTES per element,
+// per-entity system tables, and a fixed allowance (terrain, grid cells).
+#define ENGINE_COMPONENT_BYTES 64
+#define ENGINE_PERSISTENT_RESERVE                                              \
+  ((size_t)MAX_ENTITIES * (MAX_COMPONENTS * (ENGINE_COMPONENT_BYTES + 1) +    \
+                           64) +                                              \
+   ((size_t)256 << 20))
+#define ENGINE_FRAME_RESERVE                                                   \
+  ((size_t)MAX_ENTITIES * (2 * ENGINE_COMPONENT_BYTES + 64) +                 \
+   ((size_t)64 << 20))
+// On failure a reservation is halved down to this before giving up
+#define ENGINE_MIN_RESERVE ((size_t)64 << 20)
+
+typedef enum {
+  NET_MODE_LOCAL = 0, // simulate + render in one process
+  NET_MODE_SERVER,    // headless simulation, streams state to viewers
+  NET_MODE_VIEWER,    // renders state received from a server
+} NetMode_t;
+
 typedef struct EngineConfig {
   int window_width;
   int window_height;
@@ -18,6 +41,35 @@ typedef struct EngineConfig {
   int max_actors;
   int max_particles;
   int max_statics;
+
+  // Simulation: >1 splits the boids update over that many worker processes
+  int sim_workers;
+  bool sim_pin_numa;
+  bool sim_verify; // compare one decomposed step against a single-process one
+
+  // Distance LOD for the single-process update (see BoidsLod_t)
+  bool sim_lod;
+  const char *sim_lod_tiers; // "DIST:EVERY,..." (NULL = defaults)
+  int sim_lod_budget;        // max steering evaluations per tick, 0 = none
+  bool no_reorder; // keep spawn order instead of periodic Morton reordering
+  bool grid_rebuild; // rebuild the boids grid every frame (no incremental)
+  bool no_tune;           // keep the default update shape, no auto-tuning
+  bool ground_kills;      // boids touching the terrain die and respawn
+  const char *tune_cache; // auto-tuner cache file (NULL = default)
+
+  // No window / GL context (server mode)
+  bool headless;
+
+  // Back the engine arenas with transparent huge pages (--no-huge-pages)
+  bool huge_pages;
+
+  // Terrain: heightmap image to load (NULL = generate), or none at all
+  const char *terrain_path;
+  bool no_terrain;
+
+  NetMode_t net_mode;
+  const char *net_host; // viewer: server to connect to
+  int net_port;
 } EngineConfig_t;
 
 typedef struct System {
@@ -33,6 +85,13 @@ typedef struct Engine {
   StaticPool_t statics;
   ParticlePool_t particles;
 
+  Arena_t persistent; // lives until engine_shutdown
+  Arena_t frame;      // scratch, reset every engine_begin_frame
+
+  // Structural changes recorded by parallel systems, applied by
+  // engine_flush_commands
+  EntityCommands_t *commands;
+
 } Engine_t;
 
 // Initializes the engine with the given configuration.
@@ -40,11 +99,21 @@ typedef struct Engine {
 // Later: camera, ECS, pools, systems, etc.
 void engine_init(struct Engine *eng, const struct EngineConfig *cfg);
 
-// Shutdown logic (stub for now)
+// Releases all engine memory and closes the window
 void engine_shutdown(void);
 
 Engine_t *engine_get(void);
 
+// Call once per frame before any system runs; recycles the frame arena
+void engine_begin_frame(Engine_t *eng);
+
+// Sync point: applies every deferred spawn/destroy/add/remove. Call outside
+// parallel regions, between systems. Returns how many commands took effect.
+int engine_flush_commands(Engine_t *eng);
+
+// Logs arena usage and per-component column sizes
+void engine_report_memory(const Engine_t *eng);
+
 //
 //  Engine Component Store
 //
@@ -57,8 +126,34 @@ void addComponentToElement(EntityManager_t *em, ActorComponents_t *actors,
 
 void *getComponent(ActorComponents_t *actors, entity_t entity, int componentId);
 
-void RemoveComponentFromElement(ActorComponents_t *actors, entity_t entity);
+void removeComponentFromEntity(EntityManager_t *em, ActorComponents_t *actors,
+                               entity_t entity, ComponentID id);
+
+// Takes a free handle (or a new one) and the next slot. ENTITY_INVALID when
+// the tables are full.
+entity_t spawnEntity(EntityManager_t *em, EntityCategory_t cat);
+
+// Drops every component, moves the last live slot into the hole and frees
+// the handle. Returns false for stale or invalid handles.
+bool destroyEntity(EntityManager_t *em, ActorComponents_t *actors,
+                   entity_t entity);
 
 void *GetComponentArray(ActorComponents_t *actors, ComponentID cid);
 
+// Permutes every component column and the EntityManager_t tables over slots
+// [0, em->count) into Morton (Z) order of the Vector3 component `posComponent`
+// quantized over [bmin, bmax]; dead slots move to the end. Handles are
+// remapped, so only code holding raw slot indices or column pointers across
+// the call is affected (em->layoutVersion is bumped). Scratch comes from
+// `scratch` and is released before returning.
+bool reorderComponentsMorton(EntityManager_t *em, ActorComponents_t *actors,
+                             int posComponent, Vector3 bmin, Vector3 bmax,
+                             Arena_t *scratch);
+
+// Mean distance between the positions of consecutive live slots, sampled over
+// at most `samples` pairs. Small when storage order follows space.
+float measureStorageLocality(const EntityManager_t *em,
+                             const ActorComponents_t *actors,
+                             int posComponent, int samples);
+
 #endif
@@ -0,0 +1,84 @@
+#define _DEFAULT_SOURCE
+
+#include "engine_arena.h"
+#include "raylib.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define ARENA_HUGE_PAGE (2u * 1024u * 1024u)
+
+bool arena_init(Arena_t *a, const char *name, size_t reserve, bool hugePages) {
+  memset(a, 0, sizeof(*a));
+  a->name = name;
+
+  // Over-reserve one huge page so the usable range can start 2 MiB aligned
+  size_t mapSize = reserve + (hugePages ? ARENA_HUGE_PAGE : 0);
+  void *map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (map == MAP_FAILED) {
+    TraceLog(LOG_WARNING, "ARENA: [%s] cannot reserve %zu bytes", name,
+             mapSize);
+    return false;
+  }
+
+  uintptr_t base = (uintptr_t)map;
+  if (hugePages) {
+    base = (base + ARENA_HUGE_PAGE - 1) & ~(uintptr_t)(ARENA_HUGE_PAGE - 1);
+#ifdef MADV_HUGEPAGE
+    madvise((void *)base, reserve, MADV_HUGEPAGE);
+#endif
+  }
+
+  a->map = map;
+  a->mapSize = mapSize;
+  a->base = (unsigned char *)base;
+  a->reserved = reserve;
+  a->hugePages = hugePages;
+  return true;
+}
+
+void *arena_alloc_uninit(Arena_t *a, size_t size, size_t align) {
+  if (align == 0)
+    align = ARENA_CACHE_LINE;
+
+  size_t start = (a->used + align - 1) & ~(align - 1);
+  if (!a->base || start + size > a->reserved) {
+    TraceLog(LOG_ERROR, "ARENA: [%s] out of space (%zu + %zu > %zu)", a->name,
+             start, size, a->reserved);
+    return NULL;
+  }
+
+  a->used = start + size;
+  if (a->used > a->peak)
+    a->peak = a->used;
+  a->allocations++;
+  return a->base + start;
+}
+
+void *arena_alloc(Arena_t *a, size_t size, size_t align) {
+  size_t peak = a->peak;
+  unsigned char *p = arena_alloc_uninit(a, size, align);
+  // Fresh pages are already zero; only recycled space needs clearing
+  if (p && (size_t)(p - a->base) < peak) {
+    size_t start = (size_t)(p - a->base);
+    memset(p, 0, (start + size < peak ? start + size : peak) - start);
+  }
+  return p;
+}
+
+void arena_destroy(Arena_t *a) {
+  if (a->map)
+    munmap(a->map, a->mapSize);
+  memset(a, 0, sizeof(*a));
+}
+
+void arena_report(const Arena_t *a) {
+  TraceLog(LOG_INFO,
+           "ARENA: [%s] used %.2f MiB, peak %.2f MiB, reserved %.0f MiB, "
+           "%zu allocations%s",
+           a->name, (double)a->used / (1024.0 * 1024.0),
+           (double)a->peak / (1024.0 * 1024.0),
+           (double)a->reserved / (1024.0 * 1024.0), a->allocations,
+           a->hugePages ? ", huge pages" : "");
+}
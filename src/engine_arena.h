@@ -0,0 +1,53 @@
+#ifndef ENGINE_ARENA_H
+#define ENGINE_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Linear (bump) arenas backed by one reserved virtual range each.
+//
+// The engine owns two:
+//   persistent - component columns, ECS tables, terrain; lives until
+//                engine_shutdown
+//   frame      - per-frame scratch (grids, nextVel, ...); reset by
+//                engine_begin_frame, or scoped with arena_mark/arena_release
+//
+// Pages are only committed when touched, so a generous reserve costs nothing.
+// With hugePages the range is 2 MiB aligned and madvised for transparent huge
+// pages. Arenas are not thread safe: allocate outside parallel regions.
+
+#define ARENA_CACHE_LINE 64
+
+typedef struct {
+  const char *name;
+  unsigned char *base;
+  size_t reserved;
+  size_t used;
+  size_t peak;
+  size_t allocations;
+  bool hugePages;
+
+  // Raw mapping (base may be aligned inside it)
+  void *map;
+  size_t mapSize;
+} Arena_t;
+
+bool arena_init(Arena_t *a, const char *name, size_t reserve, bool hugePages);
+
+// Zeroed, `align`-aligned (power of two, 0 = cache line). NULL when full.
+void *arena_alloc(Arena_t *a, size_t size, size_t align);
+// Same, but recycled space keeps whatever the last user left in it. For
+// scratch the caller fully writes before reading (per-frame buffers).
+void *arena_alloc_uninit(Arena_t *a, size_t size, size_t align);
+
+static inline size_t arena_mark(const Arena_t *a) { return a->used; }
+static inline void arena_release(Arena_t *a, size_t mark) { a->used = mark; }
+static inline void arena_reset(Arena_t *a) { a->used = 0; }
+
+// Unmaps everything; the arena can be re-initialized afterwards
+void arena_destroy(Arena_t *a);
+
+// One log line: used / peak / reserved / allocation count
+void arena_report(const Arena_t *a);
+
+#endif
@@ -0,0 +1,283 @@
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "engine_commands.h"
+#include "engine.h"
+#include "raylib.h"
+#include <stdlib.h>
+#include <string.h>
+
+void commands_init(EntityCommands_t *q) {
+  memset(q, 0, sizeof(*q));
+  atomic_init(&q->dropped, 0);
+}
+
+void commands_destroy(EntityCommands_t *q) {
+  for (int t = 0; t < COMMANDS_MAX_THREADS; t++) {
+    free(q->buffers[t].cmds);
+    free(q->buffers[t].payload);
+  }
+  free(q->sorted);
+  free(q->spawned);
+  memset(q, 0, sizeof(*q));
+}
+
+// -----------------------------
+// Recording (any thread)
+// -----------------------------
+// The calling thread's buffer, or NULL (counted as dropped) past the limit
+static CommandBuffer_t *threadBuffer(EntityCommands_t *q, int *thread) {
+#ifdef _OPENMP
+  int t = omp_get_thread_num();
+#else
+  int t = 0;
+#endif
+  if (t >= COMMANDS_MAX_THREADS) {
+    atomic_fetch_add(&q->dropped, 1);
+    return NULL;
+  }
+  *thread = t;
+  return &q->buffers[t];
+}
+
+// Appends to the thread's buffer; NULL if it cannot grow
+static EntityCommand_t *record(EntityCommands_t *q, CommandBuffer_t *b,
+                               int thread, EntityCommandType_t type,
+                               entity_t e, int componentId) {
+  if (b->count == b->cap) {
+    int cap = b->cap ? b->cap * 2 : 256;
+    EntityCommand_t *cmds = realloc(b->cmds, sizeof(EntityCommand_t) * cap);
+    if (!cmds) {
+      atomic_fetch_add(&q->dropped, 1);
+      return NULL;
+    }
+    b->cmds = cmds;
+    b->cap = cap;
+  }
+
+  EntityCommand_t *c = &b->cmds[b->count];
+  *c = (EntityCommand_t){
+      .type = (uint8_t)type,
+      .component = (uint8_t)componentId,
+      .thread = (uint16_t)thread,
+      .seq = (uint32_t)b->count,
+      .entity = e,
+  };
+  b->count++;
+  return c;
+}
+
+entity_t commands_spawn(EntityCommands_t *q, EntityCategory_t cat) {
+  int t;
+  CommandBuffer_t *b = threadBuffer(q, &t);
+  if (!b)
+    return ENTITY_INVALID;
+  if ((uint32_t)b->spawns > COMMANDS_PENDING_INDEX_MASK) {
+    atomic_fetch_add(&q->dropped, 1);
+    return ENTITY_INVALID;
+  }
+
+  // The category rides along in the command; the id only names the spawn
+  if (!record(q, b, t, CMD_SPAWN, MakeEntityID(cat, 0), 0))
+    return ENTITY_INVALID;
+  uint32_t id = COMMANDS_PENDING_BIT |
+                (uint32_t)t << COMMANDS_PENDING_THREAD_SHIFT |
+                (uint32_t)b->spawns++;
+  return (entity_t)id;
+}
+
+void commands_add(EntityCommands_t *q, entity_t e, int componentId,
+                  const void *value, size_t size) {
+  if (e == ENTITY_INVALID || componentId < 0 || componentId >= MAX_COMPONENTS)
+    return;
+
+  int t;
+  CommandBuffer_t *b = threadBuffer(q, &t);
+  if (!b)
+    return;
+  if (b->payloadUsed + size > b->payloadCap) {
+    size_t cap = b->payloadCap ? b->payloadCap * 2 : 4096;
+    while (cap < b->payloadUsed + size)
+      cap *= 2;
+    uint8_t *p = realloc(b->payload, cap);
+    if (!p) {
+      atomic_fetch_add(&q->dropped, 1);
+      return;
+    }
+    b->payload = p;
+    b->payloadCap = cap;
+  }
+
+  EntityCommand_t *c = record(q, b, t, CMD_ADD, e, componentId);
+  if (!c)
+    return;
+  c->size = (uint32_t)size;
+  c->payload = b->payloadUsed;
+  memcpy(b->payload + b->payloadUsed, value, size);
+  b->payloadUsed += size;
+}
+
+void commands_remove(EntityCommands_t *q, entity_t e, int componentId) {
+  if (e == ENTITY_INVALID || componentId < 0 || componentId >= MAX_COMPONENTS)
+    return;
+  int t;
+  CommandBuffer_t *b = threadBuffer(q, &t);
+  if (b)
+    record(q, b, t, CMD_REMOVE, e, componentId);
+}
+
+void commands_kill(EntityCommands_t *q, entity_t e) {
+  if (e == ENTITY_INVALID)
+    return;
+  int t;
+  CommandBuffer_t *b = threadBuffer(q, &t);
+  if (b)
+    record(q, b, t, CMD_DESTROY, e, 0);
+}
+
+// -----------------------------
+// Flush (sync point, one thread)
+// -----------------------------
+entity_t commands_resolve(const EntityCommands_t *q, entity_t e) {
+  if (!commands_is_pending(e))
+    return e;
+  uint32_t id = (uint32_t)e;
+  int t = (int)((id & ~COMMANDS_PENDING_BIT) >> COMMANDS_PENDING_THREAD_SHIFT);
+  int k = q->spawnBase[t] + (int)(id & COMMANDS_PENDING_INDEX_MASK);
+  return k < q->spawnBase[t + 1] ? q->spawned[k] : ENTITY_INVALID;
+}
+
+static int slotOrNeg(const EntityManager_t *em, entity_t e) {
+  if (e == ENTITY_INVALID)
+    return -1;
+  int h = GetEntityIndex(e);
+  return h < MAX_ENTITIES ? em->slotOf[h] : -1;
+}
+
+// Adds/removes by slot, destroys last from the highest slot down; ties keep
+// (thread, recording order)
+static int cmdCmpApply(const void *a, const void *b) {
+  const EntityCommand_t *x = a, *y = b;
+  bool xd = x->type == CMD_DESTROY, yd = y->type == CMD_DESTROY;
+  if (xd != yd)
+    return xd ? 1 : -1;
+  if (x->slot != y->slot)
+    return xd ? (y->slot - x->slot) : (x->slot - y->slot);
+  if (x->component != y->component)
+    return x->component - y->component;
+  if (x->thread != y->thread)
+    return x->thread - y->thread;
+  return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+int commands_flush(EntityCommands_t *q, EntityManager_t *em,
+                   ActorComponents_t *actors) {
+  int total = 0, spawns = 0;
+  for (int t = 0; t < COMMANDS_MAX_THREADS; t++) {
+    q->spawnBase[t] = spawns;
+    total += q->buffers[t].count;
+    spawns += q->buffers[t].spawns;
+  }
+  q->spawnBase[COMMANDS_MAX_THREADS] = spawns;
+
+  q->applied = 0;
+  bool ok = true;
+  if (total > q->sortedCap) {
+    EntityCommand_t *p = realloc(q->sorted, sizeof(EntityCommand_t) * total);
+    if ((ok = p != NULL)) {
+      q->sorted = p;
+      q->sortedCap = total;
+    }
+  }
+  if (ok && spawns > q->spawnedCap) {
+    entity_t *p = realloc(q->spawned, sizeof(entity_t) * spawns);
+    if ((ok = p != NULL)) {
+      q->spawned = p;
+      q->spawnedCap = spawns;
+    }
+  }
+  if (!ok) {
+    TraceLog(LOG_ERROR, "COMMANDS: cannot apply %d commands", total);
+    atomic_fetch_add(&q->dropped, total);
+    total = 0;
+    memset(q->spawnBase, 0, sizeof(q->spawnBase));
+  }
+
+  // Phase 1: spawns in (thread, recording order); this is also the order
+  // handles come off the free list in
+  int n = 0;
+  for (int t = 0; t < COMMANDS_MAX_THREADS && total > 0; t++) {
+    const CommandBuffer_t *b = &q->buffers[t];
+    int k = q->spawnBase[t];
+    for (int i = 0; i < b->count; i++) {
+      const EntityCommand_t *c = &b->cmds[i];
+      if (c->type != CMD_SPAWN) {
+        q->sorted[n++] = *c;
+        continue;
+      }
+      entity_t e = spawnEntity(em, GetEntityCategory(c->entity));
+      if (e == ENTITY_INVALID)
+        atomic_fetch_add(&q->dropped, 1);
+      else
+        q->applied++;
+      q->spawned[k++] = e;
+    }
+  }
+
+  // Phase 2 + 3: component changes in slot order, then destroys. Slots are
+  // looked up once; destroys run from the top, so the entity a destroy moves
+  // down never has a destroy of its own still waiting.
+  EntityCommand_t *cmds = q->sorted;
+  for (int i = 0; i < n; i++) {
+    cmds[i].entity = commands_resolve(q, cmds[i].entity);
+    cmds[i].slot = slotOrNeg(em, cmds[i].entity);
+  }
+  qsort(cmds, (size_t)n, sizeof(EntityCommand_t), cmdCmpApply);
+
+  for (int i = 0; i < n; i++) {
+    const EntityCommand_t *c = &cmds[i];
+    if (c->slot < 0)
+      continue; // stale handle, or its spawn failed
+
+    switch (c->type) {
+    case CMD_ADD: {
+      if (c->component >= actors->componentCount ||
+          actors->componentStore[c->component].elementSize != c->size)
+        break;
+      const CommandBuffer_t *b = &q->buffers[c->thread];
+      addComponentToElement(em, actors, c->entity, c->component,
+                            b->payload + c->payload);
+      q->applied++;
+      break;
+    }
+    case CMD_REMOVE:
+      if (c->component >= actors->componentCount)
+        break;
+      removeComponentFromEntity(em, actors, c->entity, c->component);
+      q->applied++;
+      break;
+    case CMD_DESTROY:
+      if (destroyEntity(em, actors, c->entity))
+        q->applied++;
+      break;
+    default:
+      break;
+    }
+  }
+
+  for (int t = 0; t < COMMANDS_MAX_THREADS; t++) {
+    q->buffers[t].count = 0;
+    q->buffers[t].spawns = 0;
+    q->buffers[t].payloadUsed = 0;
+  }
+
+  int dropped = atomic_exchange(&q->dropped, 0);
+  if (dropped > 0)
+    TraceLog(LOG_WARNING, "COMMANDS: %d commands dropped (tables full)",
+             dropped);
+
+  // Occupancy or slots changed: anything cached per slot is stale
+  if (q->applied > 0)
+    em->layoutVersion++;
+  return q->applied;
+}
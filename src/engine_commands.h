@@ -0,0 +1,111 @@
+#ifndef ENGINE_COMMANDS_H
+#define ENGINE_COMMANDS_H
+
+#include "engine_components.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Deferred structural changes to the ECS.
+//
+// Spawning, destroying and adding/removing components mutate shared tables
+// (alive, masks, occupied, counts, the handle maps), so systems running
+// inside OpenMP loops record them here instead. Every thread appends to its
+// own buffer (indexed by omp_get_thread_num), so recording takes no locks and
+// touches no shared state.
+//
+// commands_spawn returns a pending id rather than a handle. It can be passed
+// to commands_add/remove/kill right away; real handles are handed out by the
+// flush, and commands_resolve maps a pending id to its handle afterwards.
+//
+// commands_flush applies everything at a sync point, outside any parallel
+// region, in a fixed order: spawns in (thread, recording order), then
+// component adds/removes by slot, then destroys from the highest slot down.
+// Ties keep (thread, recording order). Nothing depends on which thread got
+// there first, so the result is the same run to run as long as each thread
+// is given the same work (e.g. schedule(static)).
+
+#define COMMANDS_MAX_THREADS 256
+
+// Pending ids: top bit set, bit 30 clear, 8 bits of thread, 22 bits of spawn
+// index within that thread's buffer. Never equal to ENTITY_INVALID, and
+// distinct from real ids while categories stay below 2 (bit 31 clear).
+#define COMMANDS_PENDING_BIT 0x80000000u
+#define COMMANDS_PENDING_THREAD_SHIFT 22
+#define COMMANDS_PENDING_INDEX_MASK 0x3FFFFFu
+
+typedef enum {
+  CMD_SPAWN,
+  CMD_ADD,
+  CMD_REMOVE,
+  CMD_DESTROY,
+} EntityCommandType_t;
+
+typedef struct {
+  uint8_t type; // EntityCommandType_t
+  uint8_t component;
+  uint16_t thread;
+  uint32_t seq; // position in the recording thread's buffer
+  entity_t entity;
+  int32_t slot;   // filled in by the flush, for ordering
+  uint32_t size;  // CMD_ADD: payload bytes
+  size_t payload; // CMD_ADD: offset into the thread's payload buffer
+} EntityCommand_t;
+
+// One per thread, each on its own cache lines: every record writes count and
+// payloadUsed, which would otherwise bounce between neighbouring threads
+typedef struct {
+  _Alignas(ARENA_CACHE_LINE) EntityCommand_t *cmds;
+  int count, cap;
+  int spawns; // CMD_SPAWN records, = next pending spawn index
+  uint8_t *payload;
+  size_t payloadUsed, payloadCap;
+} CommandBuffer_t;
+
+typedef struct {
+  CommandBuffer_t buffers[COMMANDS_MAX_THREADS];
+
+  atomic_int dropped; // commands lost to full tables / buffers
+
+  // Flush scratch, kept between flushes
+  EntityCommand_t *sorted;
+  int sortedCap;
+
+  // Handles given to the last flush's spawns: spawnBase[thread] + index
+  entity_t *spawned;
+  int spawnedCap;
+  int spawnBase[COMMANDS_MAX_THREADS + 1];
+
+  // Last flush
+  int applied;
+} EntityCommands_t;
+
+static inline bool commands_is_pending(entity_t e) {
+  return ((uint32_t)e & (COMMANDS_PENDING_BIT | (1u << 30))) ==
+         COMMANDS_PENDING_BIT;
+}
+
+void commands_init(EntityCommands_t *q);
+void commands_destroy(EntityCommands_t *q);
+
+// Records a spawn and returns its pending id (ENTITY_INVALID if it could not
+// be recorded). The entity exists after the next flush.
+entity_t commands_spawn(EntityCommands_t *q, EntityCategory_t cat);
+
+// `value` (`size` bytes, must match the component's element size) is copied
+void commands_add(EntityCommands_t *q, entity_t e, int componentId,
+                  const void *value, size_t size);
+void commands_remove(EntityCommands_t *q, entity_t e, int componentId);
+void commands_kill(EntityCommands_t *q, entity_t e);
+
+// Applies and clears every buffer. Returns the number of commands that
+// changed something; bumps em->layoutVersion when storage moved.
+int commands_flush(EntityCommands_t *q, EntityManager_t *em,
+                   ActorComponents_t *actors);
+
+// Handle a pending id from before the last flush turned into
+// (ENTITY_INVALID if that spawn failed); other ids are returned unchanged
+entity_t commands_resolve(const EntityCommands_t *q, entity_t e);
+
+#endif
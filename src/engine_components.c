@@ -1,9 +1,26 @@
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "engine_components.h"
 #include "engine.h"
+#include "engine_arena.h"
+#include <math.h>
 #include <stdint.h>
 #include <string.h>
 #include <sys/types.h>
 
+// Handle -> slot (identity when no EntityManager_t is attached); -1 for
+// destroyed or invalid handles
+static inline int componentSlot(const ActorComponents_t *actors,
+                                entity_t entity) {
+  if (entity == ENTITY_INVALID)
+    return -1;
+  int idx = GetEntityIndex(entity);
+  if (idx >= MAX_ENTITIES)
+    return -1;
+  return actors->slotOf ? actors->slotOf[idx] : idx;
+}
+
 int registerComponent(ActorComponents_t *actors, size_t elementSize) {
   if (actors->componentCount >= MAX_COMPONENTS)
     return -1;
@@ -13,8 +30,12 @@ int registerComponent(ActorComponents_t *actors, size_t elementSize) {
   ComponentStorage_t *cs = &actors->componentStore[componentId];
   cs->id = componentId;
   cs->elementSize = elementSize;
-  cs->data = calloc(MAX_ENTITIES, elementSize);
-  cs->occupied = calloc(MAX_ENTITIES, sizeof(bool));
+  cs->data = arena_alloc(actors->arena, MAX_ENTITIES * elementSize,
+                         ARENA_CACHE_LINE);
+  cs->occupied = arena_alloc(actors->arena, MAX_ENTITIES * sizeof(bool),
+                             ARENA_CACHE_LINE);
+  if (!cs->data || !cs->occupied)
+    return -1;
   cs->count = 0;
 
   actors->componentCount++;
@@ -24,7 +45,9 @@ int registerComponent(ActorComponents_t *actors, size_t elementSize) {
 void addComponentToElement(EntityManager_t *em, ActorComponents_t *actors,
                            entity_t entity, int componentId,
                            void *elementValue) {
-  int idx = GetEntityIndex(entity);
+  int idx = componentSlot(actors, entity);
+  if (idx < 0)
+    return;
   ComponentStorage_t *cs = &actors->componentStore[componentId];
 
   uint8_t *addr = (uint8_t *)cs->data + (idx * cs->elementSize);
@@ -39,7 +62,9 @@ void addComponentToElement(EntityManager_t *em, ActorComponents_t *actors,
 
 void *getComponent(ActorComponents_t *actors, entity_t entity,
                    int componentId) {
-  int idx = GetEntityIndex(entity);
+  int idx = componentSlot(actors, entity);
+  if (idx < 0)
+    return NULL;
   ComponentStorage_t *cs = &actors->componentStore[componentId];
   if (!cs->occupied[idx])
     return NULL;
@@ -48,7 +73,9 @@ void *getComponent(ActorComponents_t *actors, entity_t entity,
 
 void removeComponentFromEntity(EntityManager_t *em, ActorComponents_t *actors,
                                entity_t entity, ComponentID id) {
-  int idx = GetEntityIndex(entity);
+  int idx = componentSlot(actors, entity);
+  if (idx < 0)
+    return;
   ComponentStorage_t *cs = &actors->componentStore[id];
 
   if (cs->occupied[idx]) {
@@ -60,7 +87,230 @@ void removeComponentFromEntity(EntityManager_t *em, ActorComponents_t *actors,
   em->masks[idx] &= ~(1u << id);
 }
 
+// -----------------------------
+// Entity lifetime
+// -----------------------------
+entity_t spawnEntity(EntityManager_t *em, EntityCategory_t cat) {
+  int handle;
+  if (em->freeCount > 0)
+    handle = em->freeHandles[--em->freeCount];
+  else if (em->handleCount < MAX_ENTITIES)
+    handle = em->handleCount++;
+  else
+    return ENTITY_INVALID;
+
+  int slot = em->count++;
+  em->alive[slot] = 1;
+  em->masks[slot] = 0;
+  em->handleOf[slot] = handle;
+  em->slotOf[handle] = slot;
+  return MakeEntityID(cat, handle);
+}
+
+bool destroyEntity(EntityManager_t *em, ActorComponents_t *actors,
+                   entity_t entity) {
+  if (entity == ENTITY_INVALID)
+    return false;
+  int handle = GetEntityIndex(entity);
+  if (handle >= MAX_ENTITIES)
+    return false;
+  int slot = em->slotOf[handle];
+  if (slot < 0 || slot >= em->count || em->handleOf[slot] != handle)
+    return false;
+
+  // Swap the last live slot into the hole so [0, count) stays dense
+  int last = --em->count;
+  for (int c = 0; c < actors->componentCount; c++) {
+    ComponentStorage_t *cs = &actors->componentStore[c];
+    uint8_t *data = cs->data;
+    if (cs->occupied[slot])
+      cs->count--;
+    if (slot != last) {
+      memcpy(data + (size_t)slot * cs->elementSize,
+             data + (size_t)last * cs->elementSize, cs->elementSize);
+      cs->occupied[slot] = cs->occupied[last];
+    }
+    memset(data + (size_t)last * cs->elementSize, 0, cs->elementSize);
+    cs->occupied[last] = false;
+  }
+  if (slot != last) {
+    em->alive[slot] = em->alive[last];
+    em->masks[slot] = em->masks[last];
+    em->handleOf[slot] = em->handleOf[last];
+    em->slotOf[em->handleOf[slot]] = slot;
+  }
+  em->alive[last] = 0;
+  em->masks[last] = 0;
+
+  em->slotOf[handle] = -1;
+  em->freeHandles[em->freeCount++] = handle;
+  em->layoutVersion++;
+  return true;
+}
+
 // return an entire array of a component
 void *GetComponentArray(ActorComponents_t *actors, ComponentID cid) {
   return actors->componentStore[cid].data;
 }
+
+// -----------------------------
+// Storage reordering
+// -----------------------------
+#define MORTON_BITS 10
+#define MORTON_DEAD (1ull << (3 * MORTON_BITS)) // sorts after every live key
+#define RADIX_BITS 11
+#define RADIX_PASSES 3 // covers the 30 key bits + the dead bit
+
+// Spreads the low 10 bits of v so there are two zero bits between each
+static inline uint32_t mortonSpread(uint32_t v) {
+  v &= 0x3FF;
+  v = (v | (v << 16)) & 0x030000FF;
+  v = (v | (v << 8)) & 0x0300F00F;
+  v = (v | (v << 4)) & 0x030C30C3;
+  v = (v | (v << 2)) & 0x09249249;
+  return v;
+}
+
+static inline uint32_t mortonQuantize(float p, float mn, float inv) {
+  float u = (p - mn) * inv;
+  if (!(u > 0.0f))
+    return 0;
+  if (u >= (float)((1 << MORTON_BITS) - 1))
+    return (1 << MORTON_BITS) - 1;
+  return (uint32_t)u;
+}
+
+// Gathers `n` elements of `elemSize` bytes into slot order via `tmp`
+static void permuteColumn(void *data, size_t elemSize, const int32_t *order,
+                          int n, void *tmp) {
+  uint8_t *src = data;
+  uint8_t *dst = tmp;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int s = 0; s < n; s++)
+    memcpy(dst + (size_t)s * elemSize, src + (size_t)order[s] * elemSize,
+           elemSize);
+  memcpy(data, tmp, (size_t)n * elemSize);
+}
+
+bool reorderComponentsMorton(EntityManager_t *em, ActorComponents_t *actors,
+                             int posComponent, Vector3 bmin, Vector3 bmax,
+                             Arena_t *scratch) {
+  const int n = em->count;
+  if (n < 2 || posComponent < 0 || posComponent >= actors->componentCount)
+    return false;
+
+  size_t mark = arena_mark(scratch);
+  uint64_t *keys = arena_alloc_uninit(scratch, sizeof(uint64_t) * (size_t)n, 0);
+  uint64_t *keysTmp =
+      arena_alloc_uninit(scratch, sizeof(uint64_t) * (size_t)n, 0);
+  int32_t *order = arena_alloc_uninit(scratch, sizeof(int32_t) * (size_t)n, 0);
+  size_t maxElem = sizeof(uint32_t);
+  for (int c = 0; c < actors->componentCount; c++)
+    if (actors->componentStore[c].elementSize > maxElem)
+      maxElem = actors->componentStore[c].elementSize;
+  void *tmp = arena_alloc_uninit(scratch, maxElem * (size_t)n, 0);
+  if (!keys || !keysTmp || !order || !tmp) {
+    arena_release(scratch, mark);
+    return false;
+  }
+
+  // Keys: (morton << 32) | old slot, so the sort is also the permutation
+  const ComponentStorage_t *ps = &actors->componentStore[posComponent];
+  const Vector3 *pos = ps->data;
+  const float scale = (float)(1 << MORTON_BITS);
+  Vector3 inv = {scale / fmaxf(bmax.x - bmin.x, 1e-6f),
+                 scale / fmaxf(bmax.y - bmin.y, 1e-6f),
+                 scale / fmaxf(bmax.z - bmin.z, 1e-6f)};
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < n; i++) {
+    uint64_t key;
+    if (!em->alive[i] || !ps->occupied[i]) {
+      key = MORTON_DEAD;
+    } else {
+      uint32_t x = mortonQuantize(pos[i].x, bmin.x, inv.x);
+      uint32_t y = mortonQuantize(pos[i].y, bmin.y, inv.y);
+      uint32_t z = mortonQuantize(pos[i].z, bmin.z, inv.z);
+      key = mortonSpread(x) | (mortonSpread(y) << 1) | (mortonSpread(z) << 2);
+    }
+    keys[i] = (key << 32) | (uint32_t)i;
+  }
+
+  // LSD radix sort on the key bits (stable, so ties keep their old order)
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    const int shift = 32 + pass * RADIX_BITS;
+    size_t hist[1 << RADIX_BITS] = {0};
+    for (int i = 0; i < n; i++)
+      hist[(keys[i] >> shift) & ((1 << RADIX_BITS) - 1)]++;
+    size_t sum = 0;
+    for (int b = 0; b < (1 << RADIX_BITS); b++) {
+      size_t h = hist[b];
+      hist[b] = sum;
+      sum += h;
+    }
+    for (int i = 0; i < n; i++)
+      keysTmp[hist[(keys[i] >> shift) & ((1 << RADIX_BITS) - 1)]++] = keys[i];
+    uint64_t *t = keys;
+    keys = keysTmp;
+    keysTmp = t;
+  }
+
+  bool identity = true;
+  for (int s = 0; s < n; s++) {
+    order[s] = (int32_t)(keys[s] & 0xFFFFFFFFu);
+    identity &= (order[s] == s);
+  }
+  if (identity) {
+    arena_release(scratch, mark);
+    return true;
+  }
+
+  for (int c = 0; c < actors->componentCount; c++) {
+    ComponentStorage_t *cs = &actors->componentStore[c];
+    permuteColumn(cs->data, cs->elementSize, order, n, tmp);
+    permuteColumn(cs->occupied, sizeof(bool), order, n, tmp);
+  }
+  permuteColumn(em->alive, sizeof(em->alive[0]), order, n, tmp);
+  permuteColumn(em->masks, sizeof(em->masks[0]), order, n, tmp);
+  permuteColumn(em->handleOf, sizeof(em->handleOf[0]), order, n, tmp);
+
+  for (int s = 0; s < n; s++)
+    em->slotOf[em->handleOf[s]] = s;
+  em->layoutVersion++;
+
+  arena_release(scratch, mark);
+  return true;
+}
+
+float measureStorageLocality(const EntityManager_t *em,
+                             const ActorComponents_t *actors,
+                             int posComponent, int samples) {
+  const int n = em->count;
+  if (n < 2 || samples < 1 || posComponent < 0 ||
+      posComponent >= actors->componentCount)
+    return 0.0f;
+
+  const ComponentStorage_t *ps = &actors->componentStore[posComponent];
+  const Vector3 *pos = ps->data;
+  int stride = (n - 1) / samples;
+  if (stride < 1)
+    stride = 1;
+
+  double sum = 0.0;
+  int pairs = 0;
+  for (int i = 0; i + 1 < n; i += stride) {
+    if (!em->alive[i] || !em->alive[i + 1] || !ps->occupied[i] ||
+        !ps->occupied[i + 1])
+      continue;
+    float dx = pos[i + 1].x - pos[i].x;
+    float dy = pos[i + 1].y - pos[i].y;
+    float dz = pos[i + 1].z - pos[i].z;
+    sum += sqrtf(dx * dx + dy * dy + dz * dz);
+    pairs++;
+  }
+  return pairs ? (float)(sum / pairs) : 0.0f;
+}
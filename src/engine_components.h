@@ -1,6 +1,7 @@
 
 #ifndef ENGINE_TYPES_H
 #define ENGINE_TYPES_H
+#include "engine_arena.h"
 #include "raylib.h"
 #include <math.h>
 #include <stdbool.h>
@@ -18,7 +19,10 @@
 #define ENTITY_TYPE_SHIFT 30
 #define ENTITY_INDEX_MASK 0x3FFFFFFF
 
+// Overridable at build time (the benchmark target raises it)
+#ifndef MAX_ENTITIES
 #define MAX_ENTITIES 8192
+#endif
 
 typedef enum {
   ET_ACTOR = 0,
@@ -43,10 +47,24 @@ typedef enum {
   ENTITY_BOID,
 } EntityType_t;
 
+// alive/masks and every component column are indexed by storage slot.
+// Entity handles carry a stable index that maps to its current slot through
+// slotOf, so storage can be reordered (reorderComponentsMorton) without
+// invalidating handles held elsewhere (e.g. GameState_t.boids). Live entities
+// occupy slots [0, count). Destroyed handles map to slot -1 and go on a free
+// list that later spawns reuse.
 typedef struct {
   uint8_t alive[MAX_ENTITIES];
   uint32_t masks[MAX_ENTITIES];
   int count;
+
+  int32_t slotOf[MAX_ENTITIES];   // handle index -> slot (-1 = destroyed)
+  int32_t handleOf[MAX_ENTITIES]; // slot -> handle index
+  uint32_t layoutVersion;         // bumped whenever slots move
+
+  int handleCount;                   // handles ever issued
+  int32_t freeHandles[MAX_ENTITIES]; // destroyed handles, reused LIFO
+  int freeCount;
 } EntityManager_t;
 
 typedef uint32_t ComponentID;
@@ -57,7 +75,7 @@ typedef uint32_t ComponentID;
 typedef struct {
   ComponentID id;
   size_t elementSize;
-  void *data; // contiguous array: element_size * max_entities
+  void *data; // contiguous array: element_size * max_entities, 64B aligned
   int count;
   bool *occupied; // per entity
 } ComponentStorage_t;
@@ -67,6 +85,9 @@ typedef struct {
   ComponentStorage_t *componentStore; //  TODO define max comps
   int componentCount;
 
+  Arena_t *arena; // where component columns are allocated
+  const int32_t *slotOf; // EntityManager_t.slotOf, resolves handles to slots
+
 } ActorComponents_t;
 
 typedef struct {
@@ -78,6 +99,8 @@ typedef struct {
 typedef struct {
 } ParticlePool_t;
 
+#define ENTITY_INVALID ((entity_t)-1)
+
 // Inline category ID helpers
 static inline entity_t MakeEntityID(EntityCategory_t cat, int index) {
   return ((uint32_t)cat << ENTITY_TYPE_SHIFT) | (index & ENTITY_INDEX_MASK);
@@ -89,4 +112,12 @@ static inline EntityCategory_t GetEntityCategory(entity_t id) {
 
 static inline int GetEntityIndex(entity_t id) { return id & ENTITY_INDEX_MASK; }
 
+// Storage slot currently holding the entity's components; -1 for destroyed
+// or invalid handles
+static inline int GetEntitySlot(const EntityManager_t *em, entity_t id) {
+  if (id == ENTITY_INVALID || GetEntityIndex(id) >= MAX_ENTITIES)
+    return -1;
+  return em->slotOf[GetEntityIndex(id)];
+}
+
 #endif
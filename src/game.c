@@ -7,7 +7,10 @@
 #include "game.h"
 #include "engine.h"
 #include "engine_components.h"
+#include "net/boids_net.h"
 #include "raylib.h"
+#include "systems/boids_decomp.h"
+#include "systems/boids_tune.h"
 #include "systems/systems.h"
 #include <math.h>
 #include <stdbool.h>
@@ -41,6 +44,59 @@ static Vector3 rand_vel(float scale) {
   };
 }
 
+// Rebuilds g_gs.boids from the live entities after spawns/destroys
+static void RefreshBoidList(Engine_t *eng) {
+  int n = 0;
+  for (int s = 0; s < eng->em.count; s++)
+    if (eng->em.alive[s])
+      g_gs.boids[n++] = MakeEntityID(ET_ACTOR, eng->em.handleOf[s]);
+  g_gs.boidCount = n;
+}
+
+// ------------------------------------------------------------
+// Default tuning (also used by the benchmark suite)
+// ------------------------------------------------------------
+void GameSetDefaultParams(GameState_t *gs) {
+  gs->neighborRadius = 8.0f;
+  gs->separationRadius = 3.0f;
+
+  gs->alignWeight = 1.0f;
+  gs->cohesionWeight = 0.8f;
+  gs->separationWeight = 1.4f;
+
+  gs->maxSpeed = 15.0f;
+  gs->minSpeed = 5.0f;
+  gs->maxForce = 6.0f;
+
+  gs->boundsMin = (Vector3){-50, -50, -50};
+  gs->boundsMax = (Vector3){50, 50, 50};
+
+  gs->terrainLookahead = 1.5f;
+  gs->terrainClearance = 2.0f;
+  gs->terrainWeight = 2.5f;
+
+  // LOD tiers (only used when lod.enabled): full rate up close, then every
+  // 2nd / 4th / 8th tick
+  gs->lod.enabled = false;
+  gs->lod.tierCount = 4;
+  gs->lod.tiers[0] = (BoidsLodTier_t){60.0f, 1};
+  gs->lod.tiers[1] = (BoidsLodTier_t){120.0f, 2};
+  gs->lod.tiers[2] = (BoidsLodTier_t){240.0f, 4};
+  gs->lod.tiers[3] = (BoidsLodTier_t){INFINITY, 8};
+  gs->lod.steerBudget = 0;
+
+  gs->reorder.enabled = true;
+  gs->reorder.period = 600;
+  gs->reorder.checkInterval = 30;
+  gs->reorder.dropFactor = 2.0f;
+
+  gs->gridIncremental = true;
+  gs->gridCellScale = 1.0f;
+  gs->simThreads = 0;
+  gs->simSchedule = BOIDS_SCHED_STATIC;
+  gs->simChunk = 0;
+}
+
 // ------------------------------------------------------------
 // One-time init
 // ------------------------------------------------------------
@@ -57,19 +113,30 @@ void GameInitBoids(Engine_t *eng) {
   if (g_gs.boidCount > MAX_ENTITIES)
     g_gs.boidCount = MAX_ENTITIES;
 
-  g_gs.neighborRadius = 8.0f;
-  g_gs.separationRadius = 3.0f;
+  GameSetDefaultParams(&g_gs);
 
-  g_gs.alignWeight = 1.0f;
-  g_gs.cohesionWeight = 0.8f;
-  g_gs.separationWeight = 1.4f;
+  g_gs.reorder.enabled = !eng->config.no_reorder;
+  g_gs.gridIncremental = !eng->config.grid_rebuild;
+  g_gs.groundKills = eng->config.ground_kills;
 
-  g_gs.maxSpeed = 15.0f;
-  g_gs.minSpeed = 5.0f;
-  g_gs.maxForce = 6.0f;
+  if (eng->config.sim_lod) {
+    g_gs.lod.enabled = true;
+    g_gs.lod.steerBudget = eng->config.sim_lod_budget;
+    if (eng->config.sim_lod_tiers &&
+        !BoidsLodParseTiers(&g_gs.lod, eng->config.sim_lod_tiers))
+      TraceLog(LOG_WARNING, "LOD: bad tier spec \"%s\", using defaults",
+               eng->config.sim_lod_tiers);
+  }
 
-  g_gs.boundsMin = (Vector3){-50, -50, -50};
-  g_gs.boundsMax = (Vector3){50, 50, 50};
+  // ---- Terrain along the floor of the bounds box (viewers build the same
+  // deterministic terrain locally, the server never draws it)
+  if (!eng->config.no_terrain) {
+    Vector3 origin = {-TERRAIN_SIZE * 0.5f, g_gs.boundsMin.y,
+                      -TERRAIN_SIZE * 0.5f};
+    g_gs.terrainEnabled =
+        TerrainInit(&g_gs.terrain, &eng->persistent, eng->config.terrain_path,
+                    origin, TERRAIN_SCALE * 3.5f, !eng->config.headless);
+  }
 
   // ---- Camera (raylib standard free camera)
   g_gs.cam.position = (Vector3){0, 40, 120};
@@ -78,32 +145,66 @@ void GameInitBoids(Engine_t *eng) {
   g_gs.cam.fovy = eng->config.fov_deg > 0 ? eng->config.fov_deg : 60.0f;
   g_gs.cam.projection = CAMERA_PERSPECTIVE;
 
-  UpdateCamera(&g_gs.cam, CAMERA_FREE);
-  DisableCursor(); // lock mouse for fly cam by default
+  if (!eng->config.headless) {
+    UpdateCamera(&g_gs.cam, CAMERA_FREE);
+    DisableCursor(); // lock mouse for fly cam by default
+  }
+
+  // ---- Viewer: nothing is simulated locally
+  if (eng->config.net_mode == NET_MODE_VIEWER) {
+    g_gs.viewer = BoidsViewerOpen(eng->config.net_host, eng->config.net_port);
+    g_inited = true;
+    return;
+  }
 
   // ---- Spawn boids
-  // IMPORTANT: your ECS must index arrays by entity INDEX (0..MAX_ENTITIES-1),
-  // not the full entity id with category bits.
-  // This spawn assumes engine_components uses GetEntityIndex(entity)
-  // internally.
+  // Handles index the ECS through EntityManager_t.slotOf; the component
+  // calls resolve them, so nothing here touches slots directly.
   for (int i = 0; i < g_gs.boidCount; i++) {
-    if (eng->em.count >= MAX_ENTITIES)
+    entity_t e = spawnEntity(&eng->em, ET_ACTOR);
+    if (e == ENTITY_INVALID) {
+      g_gs.boidCount = i;
       break;
-
-    int idx = eng->em.count++;
-    entity_t e = MakeEntityID(ET_ACTOR, idx);
+    }
     g_gs.boids[i] = e;
 
-    eng->em.alive[idx] = 1;
-    eng->em.masks[idx] = 0;
-
     Vector3 p = rand_in_box(g_gs.boundsMin, g_gs.boundsMax);
+    if (g_gs.terrainEnabled)
+      p.y = fmaxf(p.y, TerrainHeightAt(&g_gs.terrain, p.x, p.z) +
+                           g_gs.terrainClearance);
     Vector3 v = rand_vel(5.0f);
 
     addComponentToElement(&eng->em, eng->actors, e, g_gs.reg.cid_pos, &p);
     addComponentToElement(&eng->em, eng->actors, e, g_gs.reg.cid_vel, &v);
   }
 
+  // ---- Optional multi-process decomposition (forks, so do it before any
+  // OpenMP region has spun up its thread pool)
+  if (eng->config.sim_workers > 1) {
+    g_gs.decomp = BoidsDecompStart(&g_gs, eng, eng->config.sim_workers,
+                                   eng->config.sim_pin_numa);
+
+    if (g_gs.decomp && g_gs.lod.enabled)
+      TraceLog(LOG_WARNING, "LOD: ignored by the decomposed update");
+    if (g_gs.decomp && g_gs.groundKills)
+      TraceLog(LOG_WARNING, "GROUND: kills ignored by the decomposed update");
+
+    if (g_gs.decomp && eng->config.sim_verify) {
+      float err = BoidsDecompVerify(g_gs.decomp, &g_gs, eng, 1.0f / 60.0f);
+      TraceLog(err >= 0.0f && err < 1e-3f ? LOG_INFO : LOG_WARNING,
+               "DECOMP: max deviation vs single process after one step: %g",
+               err);
+    }
+  }
+
+  // ---- Auto-tune the single-process update shape
+  if (!g_gs.decomp && !eng->config.no_tune)
+    g_gs.tuner = BoidsTunerCreate(eng->config.tune_cache,
+                                  eng->config.grid_rebuild);
+
+  if (eng->config.net_mode == NET_MODE_SERVER)
+    g_gs.server = BoidsServerOpen(eng->config.net_port);
+
   g_inited = true;
 }
 
@@ -114,19 +215,45 @@ void GameUpdate(Engine_t *eng, float dt) {
   if (!g_inited)
     GameInitBoids(eng);
 
-  // Toggle mouse capture/cursor with RMB
-  if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-    if (IsCursorHidden())
-      EnableCursor();
-    else
-      DisableCursor();
+  if (!eng->config.headless) {
+    // Toggle mouse capture/cursor with RMB
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+      if (IsCursorHidden())
+        EnableCursor();
+      else
+        DisableCursor();
+    }
+
+    // Update fly camera
+    UpdateCamera(&g_gs.cam, CAMERA_FREE);
   }
 
-  // Update fly camera
-  UpdateCamera(&g_gs.cam, CAMERA_FREE);
+  // Viewer: send camera interest, take in whatever the server sent
+  if (eng->config.net_mode == NET_MODE_VIEWER) {
+    if (g_gs.viewer)
+      BoidsViewerPoll(g_gs.viewer, &g_gs.cam,
+                      (float)GetScreenWidth() / (float)GetScreenHeight());
+    return;
+  }
 
   // Update boids
-  SysBoidsUpdate(&g_gs, eng, dt);
+  if (g_gs.decomp) {
+    SysBoidsUpdateDecomp(g_gs.decomp, &g_gs, eng, dt);
+  } else {
+    SysBoidsReorder(&g_gs, eng);
+    if (g_gs.tuner)
+      SysBoidsUpdateTuned(g_gs.tuner, &g_gs, eng, dt);
+    else
+      SysBoidsUpdate(&g_gs, eng, dt);
+    SysBoidsGroundCollisions(&g_gs, eng);
+  }
+
+  // Sync point: apply structural changes recorded by the systems above
+  if (engine_flush_commands(eng) > 0)
+    RefreshBoidList(eng);
+
+  if (g_gs.server)
+    BoidsServerBroadcast(g_gs.server, &g_gs, eng, dt);
 }
 
 void GameDraw(Engine_t *eng) {
@@ -138,16 +265,43 @@ void GameDraw(Engine_t *eng) {
 
   BeginMode3D(g_gs.cam);
 
+  if (g_gs.viewer)
+    BoidsViewerBounds(g_gs.viewer, &g_gs.boundsMin, &g_gs.boundsMax);
+
   // Optional: bounds + grid for reference
   DrawBoundingBox((BoundingBox){g_gs.boundsMin, g_gs.boundsMax}, DARKGRAY);
   DrawGrid(20, 10.0f);
+  if (g_gs.terrainEnabled)
+    TerrainDraw(&g_gs.terrain);
 
   // Draw boids
-  SysBoidsDraw(&g_gs, eng);
+  if (g_gs.viewer)
+    SysBoidsDrawRemote(g_gs.viewer);
+  else if (eng->config.net_mode != NET_MODE_VIEWER)
+    SysBoidsDraw(&g_gs, eng);
 
   EndMode3D();
 
   DrawFPS(10, 10);
+  if (g_gs.viewer) {
+    BoidsViewerStats_t st = BoidsViewerGetStats(g_gs.viewer);
+    DrawText(TextFormat("remote: %d in snapshot, %d drawn, %.1f KB/s",
+                        st.visible, st.cached, st.kbytesPerSec),
+             10, 52, 16, RAYWHITE);
+  } else if (g_gs.lod.enabled && !g_gs.decomp) {
+    int total = 0, steered = 0;
+    for (int t = 0; t < g_gs.lod.tierCount; t++) {
+      total += g_gs.lod.tierBoids[t];
+      steered += g_gs.lod.tierSteered[t];
+    }
+    DrawText(TextFormat("lod: %d of %d steered this tick, near %d, far 1/%d",
+                        steered, total, g_gs.lod.tierBoids[0],
+                        g_gs.lod.tierInterval[g_gs.lod.tierCount - 1]),
+             10, 52, 16, RAYWHITE);
+  }
+  if (g_gs.groundKills && !g_gs.decomp)
+    DrawText(TextFormat("lost to the ground: %d", g_gs.groundKillsTotal), 10,
+             72, 16, RAYWHITE);
   DrawText(
       "RMB: toggle mouse capture | WASD: move | Mouse: look | Q/E: down/up", 10,
       32, 16, RAYWHITE);
@@ -157,6 +311,18 @@ void GameDraw(Engine_t *eng) {
 
 void GameShutdown(Engine_t *eng) {
   (void)eng;
+  BoidsDecompStop(g_gs.decomp);
+  g_gs.decomp = NULL;
+  BoidsServerClose(g_gs.server);
+  g_gs.server = NULL;
+  BoidsViewerClose(g_gs.viewer);
+  g_gs.viewer = NULL;
+  BoidsTunerDestroy(g_gs.tuner);
+  g_gs.tuner = NULL;
+  if (g_gs.terrainEnabled)
+    TerrainShutdown(&g_gs.terrain);
+  g_gs.terrainEnabled = false;
+
   // If you later allocate game resources (models, textures, etc.), unload them
   // here.
   g_inited = false;
@@ -1,6 +1,7 @@
 #pragma once
 #include "engine.h"
 #include "raylib.h"
+#include "terrain.h"
 #include <stdint.h>
 
 typedef struct {
@@ -10,6 +11,55 @@ typedef struct {
   int cid_params;
 } BoidComponentRegistry_t;
 
+// Simulation level of detail: boids are bucketed by distance to the camera.
+// Tier t covers distances up to tiers[t].maxDist (the last tier catches
+// everything beyond) and has its steering recomputed every tiers[t].interval
+// ticks, one round-robin slice per tick; in between a boid keeps its velocity
+// (dead reckoning). steerBudget > 0 caps steering evaluations per tick by
+// stretching the far tiers' intervals.
+#define BOIDS_LOD_MAX_TIERS 4
+#define BOIDS_LOD_MAX_INTERVAL 255
+
+typedef struct {
+  float maxDist;
+  int interval;
+} BoidsLodTier_t;
+
+typedef struct {
+  bool enabled;
+  int tierCount;
+  BoidsLodTier_t tiers[BOIDS_LOD_MAX_TIERS];
+  int steerBudget;
+
+  unsigned tick;
+
+  // Last update: boids per tier, how many were steered, effective interval
+  int tierBoids[BOIDS_LOD_MAX_TIERS];
+  int tierSteered[BOIDS_LOD_MAX_TIERS];
+  int tierInterval[BOIDS_LOD_MAX_TIERS];
+} BoidsLod_t;
+
+// Periodic reordering of component storage into Morton order of position
+// (reorderComponentsMorton). Runs every `period` ticks, or earlier when the
+// sampled gap between storage neighbours grows past dropFactor times what it
+// was right after the last reorder.
+typedef struct {
+  bool enabled;
+  int period;        // ticks, 0 = only on locality drop
+  int checkInterval; // ticks between locality samples
+  float dropFactor;
+
+  unsigned ticks; // since the last reorder
+  float sortedGap;
+  int reorders;
+} BoidsReorder_t;
+
+typedef enum {
+  BOIDS_SCHED_STATIC,
+  BOIDS_SCHED_DYNAMIC,
+  BOIDS_SCHED_GUIDED,
+} BoidsSchedule_t;
+
 typedef struct {
   BoidComponentRegistry_t reg;
 
@@ -29,9 +79,46 @@ typedef struct {
   Vector3 boundsMin;
   Vector3 boundsMax;
 
+  bool terrainEnabled;
+  Terrain_t terrain;
+  float terrainLookahead; // seconds
+  float terrainClearance;
+  float terrainWeight;
+
+  BoidsLod_t lod;
+  BoidsReorder_t reorder;
+
+  // Update shape (picked by the auto-tuner, see boids_tune.h)
+  float gridCellScale; // grid cell size in units of neighborRadius
+  int simThreads;      // OpenMP threads for the update, 0 = default
+  int simSchedule;     // BoidsSchedule_t
+  int simChunk;        // schedule chunk size, 0 = implementation default
+
+  // Keep the spatial grid across frames and only migrate boids that changed
+  // cell, instead of rebuilding it every update
+  bool gridIncremental;
+  struct BoidsGrid *grid; // persistent arena, created on first use
+
   Camera3D cam;
+
+  // Set when the update runs decomposed over worker processes
+  struct BoidsDecomp *decomp;
+
+  // Network roles (at most one is set)
+  struct BoidsServer *server;
+  struct BoidsViewer *viewer;
+
+  // Boids that touch the terrain die and respawn high up (structural changes
+  // from a parallel system, applied at the engine_flush_commands sync point)
+  bool groundKills;
+  int groundKillsTotal;
+  unsigned groundTick;
+
+  // Set while the update shape is auto-tuned
+  struct BoidsTuner *tuner;
 } GameState_t;
 
+void GameSetDefaultParams(GameState_t *gs);
 void GameInitBoids(Engine_t *eng);
 void GameUpdate(Engine_t *eng, float dt);
 void GameDraw(Engine_t *eng);
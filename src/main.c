@@ -1,12 +1,57 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "engine.h"
 #include "game.h"
+#include "net/boids_net.h"
 #include "raylib.h"
 #include "systems/systems.h"
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-int main(void) {
+static volatile sig_atomic_t g_quit = 0;
+
+static void onQuitSignal(int sig) {
+  (void)sig;
+  g_quit = 1;
+}
+
+// Headless server loop: fixed 60 Hz tick, no window, runs until SIGINT/TERM
+static void RunHeadless(Engine_t *eng) {
+  const float dt = 1.0f / 60.0f;
+  const long tickNs = (long)(dt * 1e9f);
+
+  signal(SIGINT, onQuitSignal);
+  signal(SIGTERM, onQuitSignal);
+
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (!g_quit) {
+    engine_begin_frame(eng);
+    GameUpdate(eng, dt);
+
+    next.tv_nsec += tickNs;
+    while (next.tv_nsec >= 1000000000L) {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+
+    // Fell more than a tick behind: resync instead of bursting
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double lag = (double)(now.tv_sec - next.tv_sec) +
+                 (double)(now.tv_nsec - next.tv_nsec) * 1e-9;
+    if (lag > dt)
+      next = now;
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+}
+
+int main(int argc, char **argv) {
   printf("raylib version: %s\n", RAYLIB_VERSION);
 
   SetConfigFlags(FLAG_VSYNC_HINT);
@@ -24,23 +69,97 @@ int main(void) {
       .max_actors = 256,
       .max_particles = 4096,
       .max_statics = 1024,
+
+      .huge_pages = true,
   };
 
+  // --no-huge-pages back the engine arenas with regular pages
+  // --workers N    split the simulation over N processes (slab decomposition)
+  // --pin-numa     pin those workers round-robin to NUMA nodes
+  // --verify       check one decomposed step against a single-process step
+  // --lod          distance LOD: far boids steer every Nth tick
+  // --lod-tiers S  LOD tiers as "DIST:EVERY,..." (e.g. 60:1,120:2,inf:8)
+  // --lod-budget N cap steering evaluations per tick
+  // --no-reorder   keep component storage in spawn order
+  // --grid-rebuild rebuild the spatial grid every frame
+  // --no-tune      skip the update auto-tuner
+  // --tune-cache P auto-tuner cache file (default boids_tune.cache)
+  // --ground-kills boids that touch the terrain die and respawn
+  // --server       headless simulation streaming to viewers (--port N)
+  // --viewer HOST  render a remote server's flock (--port N)
+  // --terrain PATH grayscale heightmap to load (default: generated)
+  // --no-terrain   empty box, no ground avoidance
+  cfg.net_port = NET_DEFAULT_PORT;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+      cfg.sim_workers = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--pin-numa") == 0)
+      cfg.sim_pin_numa = true;
+    else if (strcmp(argv[i], "--verify") == 0)
+      cfg.sim_verify = true;
+    else if (strcmp(argv[i], "--lod") == 0)
+      cfg.sim_lod = true;
+    else if (strcmp(argv[i], "--lod-tiers") == 0 && i + 1 < argc) {
+      cfg.sim_lod = true;
+      cfg.sim_lod_tiers = argv[++i];
+    } else if (strcmp(argv[i], "--lod-budget") == 0 && i + 1 < argc) {
+      cfg.sim_lod = true;
+      cfg.sim_lod_budget = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--no-reorder") == 0)
+      cfg.no_reorder = true;
+    else if (strcmp(argv[i], "--grid-rebuild") == 0)
+      cfg.grid_rebuild = true;
+    else if (strcmp(argv[i], "--no-huge-pages") == 0)
+      cfg.huge_pages = false;
+    else if (strcmp(argv[i], "--ground-kills") == 0)
+      cfg.ground_kills = true;
+    else if (strcmp(argv[i], "--no-tune") == 0)
+      cfg.no_tune = true;
+    else if (strcmp(argv[i], "--tune-cache") == 0 && i + 1 < argc)
+      cfg.tune_cache = argv[++i];
+    else if (strcmp(argv[i], "--terrain") == 0 && i + 1 < argc)
+      cfg.terrain_path = argv[++i];
+    else if (strcmp(argv[i], "--no-terrain") == 0)
+      cfg.no_terrain = true;
+    else if (strcmp(argv[i], "--server") == 0)
+      cfg.net_mode = NET_MODE_SERVER;
+    else if (strcmp(argv[i], "--viewer") == 0 && i + 1 < argc) {
+      cfg.net_mode = NET_MODE_VIEWER;
+      cfg.net_host = argv[++i];
+    } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+      cfg.net_port = atoi(argv[++i]);
+    else
+      printf("ignoring unknown argument: %s\n", argv[i]);
+  }
+
+  cfg.headless = (cfg.net_mode == NET_MODE_SERVER);
+
   srand((unsigned)time(0));
 
   Engine_t eng;
   engine_init(&eng, &cfg);
 
+  if (cfg.headless) {
+    GameInitBoids(&eng);
+    engine_report_memory(&eng);
+    RunHeadless(&eng);
+    GameShutdown(&eng);
+    engine_shutdown();
+    return 0;
+  }
+
   SetTargetFPS(60);
 
   // ----- Init boids "game"
   GameInitBoids(&eng);
+  engine_report_memory(&eng);
 
   // Free camera mode uses mouse look; lock cursor by default
   DisableCursor();
 
   while (!WindowShouldClose()) {
     float dt = GetFrameTime();
+    engine_begin_frame(&eng);
 
     // Toggle cursor lock/capture (Right Mouse)
     if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
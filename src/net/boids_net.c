@@ -0,0 +1,912 @@
+// boids_net.c
+// UDP snapshot streaming between a headless simulation server and viewers.
+//
+// Packet (server -> viewer), one of hdr.parts making up snapshot hdr.seq:
+//   NetSnapHeader_t
+//   entries, sorted by entity index, index deltas restarting at 0:
+//     varint((indexDelta << 1) | hasBaseline)
+//     hasBaseline: 3x zigzag varint pos residual, 3x zigzag varint vel residual
+//     otherwise:   3x uint16 pos, 3x int8 vel
+//
+// Packet (viewer -> server): NetViewerMsg_t
+
+#define _GNU_SOURCE
+
+#include "boids_net.h"
+#include "../engine.h"
+#include "../game.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NET_MAGIC_VIEWER 0x52575642u // "BVWR"
+#define NET_MAGIC_SNAP 0x504E5342u   // "BSNP"
+#define NET_CLIENT_TIMEOUT 2.0
+#define NET_SOCKET_BUFFER (4 * 1024 * 1024)
+
+typedef struct {
+  uint32_t magic;
+  uint32_t epoch;  // server epoch ackSeq belongs to
+  uint32_t ackSeq; // newest snapshot fully decoded, 0 = none
+  float camPos[3];
+  float camTarget[3];
+  float camUp[3];
+  float fovy; // degrees, vertical
+  float aspect;
+  uint32_t budgetBytes;
+} NetViewerMsg_t;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t epoch; // random per server run
+  uint32_t seq;
+  uint32_t baseSeq; // 0 = no baseline, every entry is sent in full
+  uint16_t part;    // this datagram's index within the snapshot
+  uint16_t parts;
+  uint32_t count;   // entries in this datagram
+  float boundsMin[3];
+  float boundsMax[3];
+  float maxSpeed;
+  float dt;
+  // 16.16 fixed point: position quanta travelled per tick per velocity quantum
+  int32_t velToPos[3];
+} NetSnapHeader_t;
+
+typedef struct {
+  uint16_t p[3];
+  int8_t v[3];
+} NetQBoid_t;
+
+typedef struct {
+  int32_t idx;
+  NetQBoid_t q;
+} NetEntry_t;
+
+typedef struct {
+  uint32_t seq; // 0 = empty slot
+  int count;
+  NetEntry_t *e; // NET_MAX_SNAP_ENTRIES, sorted by idx
+} NetSnapshot_t;
+
+// ------------------------------------------------------------
+// Shared encoding helpers
+// ------------------------------------------------------------
+static inline uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+static inline int32_t unzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline int varintSize(uint32_t v) {
+  int n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+static inline uint8_t *putVarint(uint8_t *w, uint32_t v) {
+  while (v >= 0x80) {
+    *w++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *w++ = (uint8_t)v;
+  return w;
+}
+
+static inline const uint8_t *getVarint(const uint8_t *r, const uint8_t *end,
+                                       uint32_t *out) {
+  uint32_t v = 0;
+  for (int shift = 0; r < end && shift < 35; shift += 7) {
+    uint8_t b = *r++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *out = v;
+      return r;
+    }
+  }
+  return NULL;
+}
+
+// Baseline position advanced by its own velocity for `ticks` ticks. Pure
+// integer math so server and viewer predict bit-identically.
+static inline uint16_t predictPos(const NetQBoid_t *b, int axis,
+                                  const int32_t velToPos[3], uint32_t ticks) {
+  int64_t d = (int64_t)b->v[axis] * velToPos[axis] * (int64_t)ticks;
+  return (uint16_t)(b->p[axis] + (int32_t)((d + 0x8000) >> 16));
+}
+
+static int entryCmpIdx(const void *a, const void *b) {
+  int32_t ia = ((const NetEntry_t *)a)->idx;
+  int32_t ib = ((const NetEntry_t *)b)->idx;
+  return (ia > ib) - (ia < ib);
+}
+
+static const NetEntry_t *findEntry(const NetSnapshot_t *s, int32_t idx) {
+  int lo = 0, hi = s->count - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) >> 1;
+    if (s->e[mid].idx == idx)
+      return &s->e[mid];
+    if (s->e[mid].idx < idx)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
+  }
+  return NULL;
+}
+
+static bool allocHistory(NetSnapshot_t *hist) {
+  for (int h = 0; h < NET_HISTORY; h++) {
+    hist[h].seq = 0;
+    hist[h].count = 0;
+    hist[h].e = malloc(sizeof(NetEntry_t) * NET_MAX_SNAP_ENTRIES);
+    if (!hist[h].e)
+      return false;
+  }
+  return true;
+}
+
+static void freeHistory(NetSnapshot_t *hist) {
+  for (int h = 0; h < NET_HISTORY; h++) {
+    free(hist[h].e);
+    hist[h].e = NULL;
+  }
+}
+
+// Seconds on a monotonic clock. GetTime() reads the window system's timer,
+// which never starts in the headless server.
+static double netNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int openUdpSocket(void) {
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0)
+    return -1;
+
+  int buf = NET_SOCKET_BUFFER;
+  setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &buf, sizeof(buf));
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf));
+
+  int flags = fcntl(sock, F_GETFL, 0);
+  fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+  return sock;
+}
+
+// ------------------------------------------------------------
+// Server
+// ------------------------------------------------------------
+typedef struct {
+  bool active;
+  struct sockaddr_in addr;
+  double lastHeard;
+  NetViewerMsg_t view;
+  uint32_t ackSeq;
+  NetSnapshot_t hist[NET_HISTORY];
+  float *priority; // per entity index, accumulates while visible but unsent
+} NetClient_t;
+
+typedef struct {
+  int32_t idx;
+  float priority;
+  NetQBoid_t q;
+} NetCandidate_t;
+
+struct BoidsServer {
+  int sock;
+  uint32_t epoch;
+  uint32_t seq;
+  NetClient_t clients[NET_MAX_CLIENTS];
+
+  NetCandidate_t *cand; // MAX_ENTITIES scratch
+  uint8_t packet[NET_MAX_PACKET];
+
+  double statsStart;
+  size_t statsBytes;
+};
+
+static int candCmpPriority(const void *a, const void *b) {
+  float pa = ((const NetCandidate_t *)a)->priority;
+  float pb = ((const NetCandidate_t *)b)->priority;
+  return (pa < pb) - (pa > pb);
+}
+
+BoidsServer_t *BoidsServerOpen(int port) {
+  BoidsServer_t *s = calloc(1, sizeof(BoidsServer_t));
+  if (!s)
+    return NULL;
+
+  s->sock = openUdpSocket();
+  s->cand = malloc(sizeof(NetCandidate_t) * MAX_ENTITIES);
+
+  struct sockaddr_in addr = {0};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+
+  if (s->sock < 0 || !s->cand ||
+      bind(s->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    TraceLog(LOG_ERROR, "NET: cannot open server on udp port %d", port);
+    BoidsServerClose(s);
+    return NULL;
+  }
+
+  // Any value that differs between runs will do; 0 is never used
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  s->epoch = (uint32_t)ts.tv_nsec ^ (uint32_t)ts.tv_sec * 2654435761u ^
+             (uint32_t)getpid() << 16;
+  if (s->epoch == 0)
+    s->epoch = 1;
+
+  s->statsStart = netNow();
+  TraceLog(LOG_INFO, "NET: serving boids on udp port %d", port);
+  return s;
+}
+
+void BoidsServerClose(BoidsServer_t *s) {
+  if (!s)
+    return;
+  for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+    freeHistory(s->clients[c].hist);
+    free(s->clients[c].priority);
+  }
+  if (s->sock >= 0)
+    close(s->sock);
+  free(s->cand);
+  free(s);
+}
+
+static NetClient_t *serverClientFor(BoidsServer_t *s,
+                                    const struct sockaddr_in *from) {
+  NetClient_t *freeSlot = NULL;
+  for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+    NetClient_t *cl = &s->clients[c];
+    if (cl->active && cl->addr.sin_addr.s_addr == from->sin_addr.s_addr &&
+        cl->addr.sin_port == from->sin_port)
+      return cl;
+    if (!cl->active && !freeSlot)
+      freeSlot = cl;
+  }
+  if (!freeSlot)
+    return NULL;
+
+  // First contact: history and priorities are allocated lazily per slot
+  if (!freeSlot->priority) {
+    freeSlot->priority = malloc(sizeof(float) * MAX_ENTITIES);
+    if (!freeSlot->priority || !allocHistory(freeSlot->hist)) {
+      freeHistory(freeSlot->hist);
+      free(freeSlot->priority);
+      freeSlot->priority = NULL;
+      return NULL;
+    }
+  }
+  for (int h = 0; h < NET_HISTORY; h++)
+    freeSlot->hist[h].seq = 0;
+  memset(freeSlot->priority, 0, sizeof(float) * MAX_ENTITIES);
+
+  freeSlot->active = true;
+  freeSlot->addr = *from;
+  freeSlot->ackSeq = 0;
+
+  char ip[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &from->sin_addr, ip, sizeof(ip));
+  TraceLog(LOG_INFO, "NET: viewer %s:%d connected", ip,
+           ntohs(from->sin_port));
+  return freeSlot;
+}
+
+static void serverReceive(BoidsServer_t *s, double now) {
+  NetViewerMsg_t msg;
+  struct sockaddr_in from;
+  socklen_t fromLen = sizeof(from);
+
+  for (;;) {
+    ssize_t n = recvfrom(s->sock, &msg, sizeof(msg), 0,
+                         (struct sockaddr *)&from, &fromLen);
+    if (n < 0)
+      break;
+    if (n != (ssize_t)sizeof(msg) || msg.magic != NET_MAGIC_VIEWER)
+      continue;
+
+    NetClient_t *cl = serverClientFor(s, &from);
+    if (!cl)
+      continue;
+
+    cl->view = msg;
+    cl->lastHeard = now;
+    if (msg.epoch == s->epoch && msg.ackSeq > cl->ackSeq &&
+        msg.ackSeq <= s->seq)
+      cl->ackSeq = msg.ackSeq;
+  }
+
+  for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+    NetClient_t *cl = &s->clients[c];
+    if (cl->active && now - cl->lastHeard > NET_CLIENT_TIMEOUT) {
+      cl->active = false;
+      TraceLog(LOG_INFO, "NET: viewer slot %d timed out", c);
+    }
+  }
+}
+
+// Builds the candidate list (visible boids, highest priority first)
+static int serverGatherVisible(BoidsServer_t *s, NetClient_t *cl,
+                               GameState_t *gs, Engine_t *eng, Vector3 bmin,
+                               Vector3 ext) {
+  const NetViewerMsg_t *vw = &cl->view;
+  Vector3 eye = {vw->camPos[0], vw->camPos[1], vw->camPos[2]};
+  Vector3 fwd = {vw->camTarget[0] - eye.x, vw->camTarget[1] - eye.y,
+                 vw->camTarget[2] - eye.z};
+  Vector3 up = {vw->camUp[0], vw->camUp[1], vw->camUp[2]};
+
+  float fl = sqrtf(fwd.x * fwd.x + fwd.y * fwd.y + fwd.z * fwd.z);
+  if (fl < 1e-5f)
+    return 0;
+  fwd = (Vector3){fwd.x / fl, fwd.y / fl, fwd.z / fl};
+
+  // right = fwd x up, up' = right x fwd
+  Vector3 right = {fwd.y * up.z - fwd.z * up.y, fwd.z * up.x - fwd.x * up.z,
+                   fwd.x * up.y - fwd.y * up.x};
+  float rl = sqrtf(right.x * right.x + right.y * right.y + right.z * right.z);
+  if (rl < 1e-5f)
+    return 0;
+  right = (Vector3){right.x / rl, right.y / rl, right.z / rl};
+  up = (Vector3){right.y * fwd.z - right.z * fwd.y,
+                 right.z * fwd.x - right.x * fwd.z,
+                 right.x * fwd.y - right.y * fwd.x};
+
+  float tanV = tanf(vw->fovy * 0.5f * DEG2RAD);
+  float tanH = tanV * (vw->aspect > 0.0f ? vw->aspect : 1.0f);
+  const float margin = 2.0f; // boid line length + slack
+
+  Vector3 *pos = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_pos);
+  Vector3 *vel = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_vel);
+  ComponentStorage_t *posS = &eng->actors->componentStore[gs->reg.cid_pos];
+  float invSpeed = gs->maxSpeed > 0.0f ? 127.0f / gs->maxSpeed : 0.0f;
+
+  // Storage slots move when the ECS reorders; the wire and the per-client
+  // priorities use the stable handle index instead
+  const int32_t *handleOf = eng->em.handleOf;
+
+  int n = 0;
+  for (int i = 0; i < eng->em.count; i++) {
+    if (!eng->em.alive[i] || !posS->occupied[i])
+      continue;
+    int h = handleOf[i];
+
+    Vector3 d = {pos[i].x - eye.x, pos[i].y - eye.y, pos[i].z - eye.z};
+    float z = d.x * fwd.x + d.y * fwd.y + d.z * fwd.z;
+    float x = d.x * right.x + d.y * right.y + d.z * right.z;
+    float y = d.x * up.x + d.y * up.y + d.z * up.z;
+
+    if (z < -margin || fabsf(x) > z * tanH + margin ||
+        fabsf(y) > z * tanV + margin) {
+      cl->priority[h] = 0.0f;
+      continue;
+    }
+
+    // Near boids gain priority faster; unsent ones keep accumulating
+    cl->priority[h] += 1.0f / (1.0f + z * 0.05f);
+
+    NetCandidate_t *c = &s->cand[n++];
+    c->idx = h;
+    c->priority = cl->priority[h];
+
+    float p3[3] = {pos[i].x - bmin.x, pos[i].y - bmin.y, pos[i].z - bmin.z};
+    float e3[3] = {ext.x, ext.y, ext.z};
+    float v3[3] = {vel[i].x, vel[i].y, vel[i].z};
+    for (int a = 0; a < 3; a++) {
+      float u = e3[a] > 0.0f ? p3[a] / e3[a] * 65535.0f : 0.0f;
+      c->q.p[a] = (uint16_t)fminf(fmaxf(u + 0.5f, 0.0f), 65535.0f);
+      float q = v3[a] * invSpeed;
+      c->q.v[a] = (int8_t)fminf(fmaxf(roundf(q), -127.0f), 127.0f);
+    }
+  }
+
+  qsort(s->cand, (size_t)n, sizeof(NetCandidate_t), candCmpPriority);
+  return n;
+}
+
+// Exact payload size of one entry, excluding its index varint
+static int entryPayloadSize(const NetQBoid_t *q, const NetQBoid_t *base,
+                            const int32_t velToPos[3], uint32_t ticks) {
+  if (!base)
+    return 9;
+  int size = 0;
+  for (int a = 0; a < 3; a++) {
+    int16_t r = (int16_t)(q->p[a] - predictPos(base, a, velToPos, ticks));
+    size += varintSize(zigzag(r));
+    size += varintSize(zigzag((int32_t)q->v[a] - base->v[a]));
+  }
+  return size;
+}
+
+static const NetEntry_t *baseEntry(const NetSnapshot_t *base, int32_t idx) {
+  return base ? findEntry(base, idx) : NULL;
+}
+
+static void serverSendPart(BoidsServer_t *s, NetClient_t *cl,
+                           NetSnapHeader_t *hdr, const NetSnapshot_t *base,
+                           uint32_t ticks, const NetEntry_t *e, int count) {
+  hdr->count = (uint32_t)count;
+
+  uint8_t *w = s->packet;
+  memcpy(w, hdr, sizeof(*hdr));
+  w += sizeof(*hdr);
+
+  int32_t prev = 0;
+  for (int k = 0; k < count; k++) {
+    const NetEntry_t *b = baseEntry(base, e[k].idx);
+
+    w = putVarint(w, ((uint32_t)(e[k].idx - prev) << 1) | (b ? 1u : 0u));
+    prev = e[k].idx;
+
+    if (b) {
+      for (int a = 0; a < 3; a++) {
+        int16_t r = (int16_t)(e[k].q.p[a] -
+                              predictPos(&b->q, a, hdr->velToPos, ticks));
+        w = putVarint(w, zigzag(r));
+      }
+      for (int a = 0; a < 3; a++)
+        w = putVarint(w, zigzag((int32_t)e[k].q.v[a] - b->q.v[a]));
+    } else {
+      memcpy(w, e[k].q.p, sizeof(e[k].q.p));
+      w += sizeof(e[k].q.p);
+      memcpy(w, e[k].q.v, sizeof(e[k].q.v));
+      w += sizeof(e[k].q.v);
+    }
+  }
+
+  size_t len = (size_t)(w - s->packet);
+  sendto(s->sock, s->packet, len, 0, (struct sockaddr *)&cl->addr,
+         sizeof(cl->addr));
+  s->statsBytes += len;
+}
+
+static void serverSendTo(BoidsServer_t *s, NetClient_t *cl, GameState_t *gs,
+                         Engine_t *eng, float dt) {
+  Vector3 bmin = gs->boundsMin;
+  Vector3 ext = {gs->boundsMax.x - bmin.x, gs->boundsMax.y - bmin.y,
+                 gs->boundsMax.z - bmin.z};
+
+  NetSnapHeader_t hdr = {0};
+  hdr.magic = NET_MAGIC_SNAP;
+  hdr.epoch = s->epoch;
+  hdr.seq = s->seq;
+  hdr.boundsMin[0] = bmin.x;
+  hdr.boundsMin[1] = bmin.y;
+  hdr.boundsMin[2] = bmin.z;
+  hdr.boundsMax[0] = gs->boundsMax.x;
+  hdr.boundsMax[1] = gs->boundsMax.y;
+  hdr.boundsMax[2] = gs->boundsMax.z;
+  hdr.maxSpeed = gs->maxSpeed;
+  hdr.dt = dt;
+
+  float e3[3] = {ext.x, ext.y, ext.z};
+  for (int a = 0; a < 3; a++) {
+    float quantaPerUnit = e3[a] > 0.0f ? 65535.0f / e3[a] : 0.0f;
+    hdr.velToPos[a] =
+        (int32_t)lroundf(gs->maxSpeed / 127.0f * dt * quantaPerUnit * 65536.0f);
+  }
+
+  // Baseline = newest acknowledged snapshot still in history
+  const NetSnapshot_t *base = NULL;
+  if (cl->ackSeq && s->seq - cl->ackSeq < NET_HISTORY) {
+    const NetSnapshot_t *h = &cl->hist[cl->ackSeq % NET_HISTORY];
+    if (h->seq == cl->ackSeq)
+      base = h;
+  }
+  uint32_t ticks = base ? s->seq - base->seq : 0;
+  hdr.baseSeq = base ? base->seq : 0;
+
+  int n = serverGatherVisible(s, cl, gs, eng, bmin, ext);
+
+  // Greedy fill by priority. Entries are at most 23 bytes (5-byte index
+  // varint + 6 residual varints), so reserving that much per datagram keeps
+  // the split below from ever needing more than `parts` datagrams.
+  uint32_t budget = cl->view.budgetBytes;
+  if (budget == 0 || budget > NET_MAX_PARTS * NET_MAX_PACKET)
+    budget = NET_MAX_PARTS * NET_MAX_PACKET;
+  const int partRoom = NET_MAX_PACKET - (int)sizeof(NetSnapHeader_t);
+  int maxParts = (int)budget / NET_MAX_PACKET;
+  if (maxParts < 1)
+    maxParts = 1;
+  int room = maxParts * (partRoom - 23);
+
+  NetSnapshot_t *out = &cl->hist[s->seq % NET_HISTORY];
+  out->seq = 0; // invalid until fully written
+  out->count = 0;
+
+  for (int k = 0; k < n && out->count < NET_MAX_SNAP_ENTRIES; k++) {
+    const NetCandidate_t *c = &s->cand[k];
+    const NetEntry_t *b = baseEntry(base, c->idx);
+    int size = 5 + entryPayloadSize(&c->q, b ? &b->q : NULL, hdr.velToPos,
+                                    ticks);
+    if (size > room)
+      break;
+    room -= size;
+
+    out->e[out->count++] = (NetEntry_t){c->idx, c->q};
+    cl->priority[c->idx] = 0.0f;
+  }
+
+  qsort(out->e, (size_t)out->count, sizeof(NetEntry_t), entryCmpIdx);
+
+  // Split into datagrams by exact encoded size; each restarts the index delta
+  int partStart[NET_MAX_PARTS + 1];
+  int parts = 0, used = 0;
+  int32_t prev = 0;
+  partStart[0] = 0;
+  for (int k = 0; k < out->count; k++) {
+    const NetEntry_t *e = &out->e[k];
+    const NetEntry_t *b = baseEntry(base, e->idx);
+    int size = entryPayloadSize(&e->q, b ? &b->q : NULL, hdr.velToPos, ticks);
+    int tag = varintSize(((uint32_t)(e->idx - prev) << 1) | 1u);
+    if (used + size + tag > partRoom) {
+      partStart[++parts] = k;
+      used = 0;
+      tag = varintSize(((uint32_t)e->idx << 1) | 1u);
+    }
+    used += size + tag;
+    prev = e->idx;
+  }
+  partStart[++parts] = out->count;
+
+  hdr.parts = (uint16_t)parts;
+  for (int p = 0; p < parts; p++) {
+    hdr.part = (uint16_t)p;
+    serverSendPart(s, cl, &hdr, base, ticks, out->e + partStart[p],
+                   partStart[p + 1] - partStart[p]);
+  }
+  out->seq = s->seq;
+}
+
+void BoidsServerBroadcast(BoidsServer_t *s, GameState_t *gs, Engine_t *eng,
+                          float dt) {
+  double now = netNow();
+  serverReceive(s, now);
+
+  s->seq++;
+  if (s->seq == 0) // 0 means "none" on the wire
+    s->seq = 1;
+
+  int live = 0;
+  for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+    if (!s->clients[c].active)
+      continue;
+    serverSendTo(s, &s->clients[c], gs, eng, dt);
+    live++;
+  }
+
+  if (now - s->statsStart >= 5.0) {
+    if (live > 0)
+      TraceLog(LOG_INFO, "NET: %d viewer(s), %.1f KB/s total", live,
+               (double)s->statsBytes / 1024.0 / (now - s->statsStart));
+    s->statsStart = now;
+    s->statsBytes = 0;
+  }
+}
+
+// ------------------------------------------------------------
+// Viewer
+// ------------------------------------------------------------
+struct BoidsViewer {
+  int sock;
+  struct sockaddr_in server;
+
+  NetSnapshot_t hist[NET_HISTORY];
+  uint32_t lastSeq; // newest snapshot with any datagram decoded
+  uint32_t ackSeq;  // newest snapshot with every datagram decoded
+  uint32_t epoch;
+  NetSnapHeader_t lastHdr;
+  bool haveHdr;
+
+  // Snapshot being assembled from its datagrams
+  uint32_t asmSeq;
+  uint64_t asmParts; // bit per datagram received
+
+  // Render cache, indexed by entity index
+  Vector3 *pos;
+  Vector3 *vel;
+  uint32_t *seenSeq;
+  int32_t highWater; // one past the largest index ever received
+
+  BoidsViewerStats_t stats;
+  double statsStart;
+  size_t statsBytes;
+
+  uint8_t packet[NET_MAX_PACKET];
+};
+
+BoidsViewer_t *BoidsViewerOpen(const char *host, int port) {
+  BoidsViewer_t *v = calloc(1, sizeof(BoidsViewer_t));
+  if (!v)
+    return NULL;
+
+  v->sock = openUdpSocket();
+  v->pos = malloc(sizeof(Vector3) * MAX_ENTITIES);
+  v->vel = malloc(sizeof(Vector3) * MAX_ENTITIES);
+  v->seenSeq = calloc(MAX_ENTITIES, sizeof(uint32_t));
+
+  struct addrinfo hints = {0};
+  struct addrinfo *res = NULL;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  char portStr[16];
+  snprintf(portStr, sizeof(portStr), "%d", port);
+
+  if (v->sock < 0 || !v->pos || !v->vel || !v->seenSeq ||
+      !allocHistory(v->hist) || getaddrinfo(host, portStr, &hints, &res) != 0) {
+    TraceLog(LOG_ERROR, "NET: cannot reach server %s:%d", host, port);
+    BoidsViewerClose(v);
+    return NULL;
+  }
+
+  memcpy(&v->server, res->ai_addr, sizeof(v->server));
+  freeaddrinfo(res);
+
+  v->statsStart = netNow();
+  TraceLog(LOG_INFO, "NET: viewing server %s:%d", host, port);
+  return v;
+}
+
+void BoidsViewerClose(BoidsViewer_t *v) {
+  if (!v)
+    return;
+  if (v->sock >= 0)
+    close(v->sock);
+  freeHistory(v->hist);
+  free(v->pos);
+  free(v->vel);
+  free(v->seenSeq);
+  free(v);
+}
+
+// The server restarted: its sequence numbers mean nothing to us any more
+static void viewerReset(BoidsViewer_t *v, uint32_t epoch) {
+  for (int h = 0; h < NET_HISTORY; h++)
+    v->hist[h].seq = 0;
+  memset(v->seenSeq, 0, sizeof(uint32_t) * (size_t)v->highWater);
+  v->highWater = 0;
+  v->lastSeq = 0;
+  v->ackSeq = 0;
+  v->asmSeq = 0;
+  v->asmParts = 0;
+  v->epoch = epoch;
+  TraceLog(LOG_INFO, "NET: server restarted, resyncing");
+}
+
+static void viewerDecode(BoidsViewer_t *v, const uint8_t *buf, size_t len) {
+  NetSnapHeader_t hdr;
+  if (len < sizeof(hdr))
+    return;
+  memcpy(&hdr, buf, sizeof(hdr));
+  if (hdr.magic != NET_MAGIC_SNAP || hdr.count > NET_MAX_SNAP_ENTRIES ||
+      hdr.parts == 0 || hdr.parts > NET_MAX_PARTS || hdr.part >= hdr.parts)
+    return;
+
+  if (hdr.epoch != v->epoch) {
+    if (v->haveHdr)
+      viewerReset(v, hdr.epoch);
+    v->epoch = hdr.epoch;
+  }
+  if (hdr.seq < v->asmSeq)
+    return; // older tick
+
+  const NetSnapshot_t *base = NULL;
+  if (hdr.baseSeq) {
+    base = &v->hist[hdr.baseSeq % NET_HISTORY];
+    if (base->seq != hdr.baseSeq)
+      return; // baseline lost; the server falls back to full entries
+  }
+  uint32_t ticks = base ? hdr.seq - hdr.baseSeq : 0;
+
+  NetSnapshot_t *out = &v->hist[hdr.seq % NET_HISTORY];
+  if (out == base)
+    return;
+  if (hdr.seq != v->asmSeq) {
+    // A newer tick started; whatever is missing from the previous one is lost
+    v->asmSeq = hdr.seq;
+    v->asmParts = 0;
+    out->seq = 0;
+    out->count = 0;
+  }
+  uint64_t bit = 1ull << hdr.part;
+  if ((v->asmParts & bit) ||
+      out->count + (int)hdr.count > NET_MAX_SNAP_ENTRIES)
+    return;
+
+  // Decode past the end of the snapshot; only kept if the datagram is whole
+  NetEntry_t *dst = out->e + out->count;
+  const uint8_t *r = buf + sizeof(hdr);
+  const uint8_t *end = buf + len;
+  int32_t idx = 0;
+
+  for (uint32_t k = 0; k < hdr.count; k++) {
+    uint32_t tag;
+    if (!(r = getVarint(r, end, &tag)))
+      return;
+    idx += (int32_t)(tag >> 1);
+    if (idx < 0 || idx >= MAX_ENTITIES)
+      return;
+
+    NetEntry_t e = {.idx = idx};
+    if (tag & 1) {
+      const NetEntry_t *be = base ? findEntry(base, idx) : NULL;
+      if (!be)
+        return;
+      const NetQBoid_t *b = &be->q;
+
+      for (int a = 0; a < 3; a++) {
+        uint32_t z;
+        if (!(r = getVarint(r, end, &z)))
+          return;
+        e.q.p[a] = (uint16_t)(predictPos(b, a, hdr.velToPos, ticks) +
+                              unzigzag(z));
+      }
+      for (int a = 0; a < 3; a++) {
+        uint32_t z;
+        if (!(r = getVarint(r, end, &z)))
+          return;
+        e.q.v[a] = (int8_t)(b->v[a] + unzigzag(z));
+      }
+    } else {
+      if (end - r < 9)
+        return;
+      memcpy(e.q.p, r, sizeof(e.q.p));
+      r += sizeof(e.q.p);
+      memcpy(e.q.v, r, sizeof(e.q.v));
+      r += sizeof(e.q.v);
+    }
+
+    dst[k] = e;
+  }
+  out->count += (int)hdr.count;
+  v->asmParts |= bit;
+
+  // Complete: usable as a baseline, so acknowledge it
+  uint64_t all = hdr.parts == 64 ? ~0ull : (1ull << hdr.parts) - 1;
+  if (v->asmParts == all) {
+    qsort(out->e, (size_t)out->count, sizeof(NetEntry_t), entryCmpIdx);
+    out->seq = hdr.seq;
+    v->ackSeq = hdr.seq;
+  }
+
+  // Refresh render cache
+  float ext[3], mn[3];
+  for (int a = 0; a < 3; a++) {
+    mn[a] = hdr.boundsMin[a];
+    ext[a] = hdr.boundsMax[a] - hdr.boundsMin[a];
+  }
+  float velScale = hdr.maxSpeed / 127.0f;
+
+  for (uint32_t k = 0; k < hdr.count; k++) {
+    const NetEntry_t *e = &dst[k];
+    v->pos[e->idx] = (Vector3){mn[0] + e->q.p[0] / 65535.0f * ext[0],
+                               mn[1] + e->q.p[1] / 65535.0f * ext[1],
+                               mn[2] + e->q.p[2] / 65535.0f * ext[2]};
+    v->vel[e->idx] = (Vector3){e->q.v[0] * velScale, e->q.v[1] * velScale,
+                               e->q.v[2] * velScale};
+    v->seenSeq[e->idx] = hdr.seq;
+    if (e->idx >= v->highWater)
+      v->highWater = e->idx + 1;
+  }
+
+  v->lastSeq = hdr.seq;
+  v->lastHdr = hdr;
+  v->haveHdr = true;
+  v->stats.visible = out->count;
+  v->stats.seq = hdr.seq;
+}
+
+void BoidsViewerPoll(BoidsViewer_t *v, const Camera3D *cam, float aspect) {
+  NetViewerMsg_t msg = {0};
+  msg.magic = NET_MAGIC_VIEWER;
+  msg.epoch = v->epoch;
+  msg.ackSeq = v->ackSeq;
+  msg.camPos[0] = cam->position.x;
+  msg.camPos[1] = cam->position.y;
+  msg.camPos[2] = cam->position.z;
+  msg.camTarget[0] = cam->target.x;
+  msg.camTarget[1] = cam->target.y;
+  msg.camTarget[2] = cam->target.z;
+  msg.camUp[0] = cam->up.x;
+  msg.camUp[1] = cam->up.y;
+  msg.camUp[2] = cam->up.z;
+  msg.fovy = cam->fovy;
+  msg.aspect = aspect;
+  msg.budgetBytes = NET_TICK_BUDGET;
+
+  sendto(v->sock, &msg, sizeof(msg), 0, (struct sockaddr *)&v->server,
+         sizeof(v->server));
+
+  for (;;) {
+    ssize_t n = recv(v->sock, v->packet, sizeof(v->packet), 0);
+    if (n < 0)
+      break;
+    v->statsBytes += (size_t)n;
+    viewerDecode(v, v->packet, (size_t)n);
+  }
+
+  double now = netNow();
+  if (now - v->statsStart >= 1.0) {
+    v->stats.kbytesPerSec =
+        (float)((double)v->statsBytes / 1024.0 / (now - v->statsStart));
+    v->statsStart = now;
+    v->statsBytes = 0;
+  }
+}
+
+bool BoidsViewerBounds(const BoidsViewer_t *v, Vector3 *mn, Vector3 *mx) {
+  if (!v->haveHdr)
+    return false;
+  *mn = (Vector3){v->lastHdr.boundsMin[0], v->lastHdr.boundsMin[1],
+                  v->lastHdr.boundsMin[2]};
+  *mx = (Vector3){v->lastHdr.boundsMax[0], v->lastHdr.boundsMax[1],
+                  v->lastHdr.boundsMax[2]};
+  return true;
+}
+
+BoidsViewerStats_t BoidsViewerGetStats(const BoidsViewer_t *v) {
+  return v->stats;
+}
+
+void SysBoidsDrawRemote(BoidsViewer_t *v) {
+  if (!v->haveHdr)
+    return;
+
+  float tickDt = v->lastHdr.dt;
+  int cached = 0;
+
+  rlBegin(RL_LINES);
+  for (int i = 0; i < v->highWater; i++) {
+    uint32_t seen = v->seenSeq[i];
+    if (!seen || v->lastSeq - seen > NET_STALE_TICKS)
+      continue;
+    cached++;
+
+    // Dead-reckon boids that were not in the latest snapshot
+    Vector3 vel = v->vel[i];
+    float age = (float)(v->lastSeq - seen) * tickDt;
+    Vector3 p = {v->pos[i].x + vel.x * age, v->pos[i].y + vel.y * age,
+                 v->pos[i].z + vel.z * age};
+
+    float sp2 = vel.x * vel.x + vel.y * vel.y + vel.z * vel.z;
+    if (sp2 < 0.000001f)
+      continue;
+    float invSp = 1.0f / sqrtf(sp2);
+
+    Vector3 dir = (Vector3){vel.x * invSp, vel.y * invSp, vel.z * invSp};
+
+    float hue = (dir.x * 0.5f + 0.5f) * 360.0f;
+    float sat = 0.15f + (dir.y * 0.5f + 0.5f) * 0.85f;
+    Color c = ColorFromHSV(hue, sat, 0.95f);
+
+    Vector3 tip =
+        (Vector3){p.x + dir.x * 1.6f, p.y + dir.y * 1.6f, p.z + dir.z * 1.6f};
+
+    rlColor4ub(c.r, c.g, c.b, c.a);
+    rlVertex3f(p.x, p.y, p.z);
+    rlVertex3f(tip.x, tip.y, tip.z);
+  }
+  rlEnd();
+
+  v->stats.cached = cached;
+}
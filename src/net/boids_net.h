@@ -0,0 +1,71 @@
+#pragma once
+#include "../engine.h"
+#include "../game.h"
+#include "raylib.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Headless simulation server + lightweight viewer over UDP.
+//
+// Viewers send their camera (and the newest snapshot they decoded) every
+// frame. For each viewer the server culls boids against that camera frustum,
+// ranks the visible ones with a priority accumulator (near boids gain
+// priority faster) and packs as many as fit in the viewer's per-tick byte
+// budget. A tick's snapshot is split into datagrams of at most NET_MAX_PACKET
+// bytes so they are never IP-fragmented; each one decodes on its own.
+// Positions are quantized to 16 bits per axis inside the bounds box and
+// velocities to 8 bits; a boid the viewer already has in its acknowledged
+// baseline snapshot is sent as a small residual against the baseline
+// extrapolated by its velocity. Bandwidth therefore follows what a viewer
+// can see, not the flock size.
+//
+// Each server run picks a random epoch. A viewer that sees the epoch change
+// (the server restarted and its sequence numbers start over) drops everything
+// it had and starts again.
+//
+// Wire format is native-endian: server and viewers are the same binary.
+
+#define NET_DEFAULT_PORT 7777
+#define NET_MAX_CLIENTS 8
+#define NET_HISTORY 32          // snapshots kept for delta baselines
+#define NET_MAX_PACKET 1200     // below common path MTUs, no IP fragmentation
+#define NET_MAX_PARTS 64        // datagrams per snapshot
+#define NET_TICK_BUDGET 64000   // bytes per tick a viewer asks for
+#define NET_MAX_SNAP_ENTRIES 8192
+#define NET_STALE_TICKS 30      // viewer drops boids not refreshed for this long
+
+typedef struct BoidsServer BoidsServer_t;
+typedef struct BoidsViewer BoidsViewer_t;
+
+typedef struct {
+  int visible;       // boids in the last decoded snapshot
+  int cached;        // boids currently drawn (fresh enough)
+  float kbytesPerSec; // received payload rate
+  uint32_t seq;      // newest snapshot sequence decoded
+} BoidsViewerStats_t;
+
+// ---- Server
+BoidsServer_t *BoidsServerOpen(int port);
+
+// Drains viewer messages, then sends each live viewer one snapshot. `dt` is
+// the fixed simulation tick the server runs at.
+void BoidsServerBroadcast(BoidsServer_t *s, GameState_t *gs, Engine_t *eng,
+                          float dt);
+
+void BoidsServerClose(BoidsServer_t *s);
+
+// ---- Viewer
+BoidsViewer_t *BoidsViewerOpen(const char *host, int port);
+
+// Sends the camera + ack, then decodes every snapshot that has arrived.
+void BoidsViewerPoll(BoidsViewer_t *v, const Camera3D *cam, float aspect);
+
+// Bounds box of the remote simulation (valid after the first snapshot)
+bool BoidsViewerBounds(const BoidsViewer_t *v, Vector3 *mn, Vector3 *mx);
+
+BoidsViewerStats_t BoidsViewerGetStats(const BoidsViewer_t *v);
+
+// Draws the received boids the same way SysBoidsDraw does
+void SysBoidsDrawRemote(BoidsViewer_t *v);
+
+void BoidsViewerClose(BoidsViewer_t *v);
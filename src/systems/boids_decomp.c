@@ -0,0 +1,679 @@
+// boids_decomp.c
+// Slab decomposition of the boids update over forked worker processes.
+//
+// Shared segment layout (mapped before fork, so the addresses are identical in
+// every process):
+//   DecompControl_t                     barriers, step params, slab counts
+//   DecompBoid_t  slab[workers][MAX_ENTITIES]   boids owned by each worker
+//   DecompRing_t  ring[workers][2]      outgoing rings (to left / to right)
+//
+// A step is: ghosts out -> ghosts in -> steer + integrate -> migrants out ->
+// migrants in. Every ring transfer is terminated by an end marker, so workers
+// only ever wait on their direct neighbours, never on a global barrier.
+
+#define _GNU_SOURCE
+
+#include "boids_decomp.h"
+#include "../engine.h"
+#include "../game.h"
+#include "boids_kernel.h"
+#include "raylib.h"
+#include "systems.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DECOMP_DIR_LEFT 0
+#define DECOMP_DIR_RIGHT 1
+#define DECOMP_END_MARKER ((entity_t)-1)
+
+// Worker grids never get finer than this per axis
+#define DECOMP_MAX_DIM 64
+
+typedef struct {
+  entity_t id;
+  Vector3 pos;
+  Vector3 vel;
+} DecompBoid_t;
+
+// Capacity is 2 * (MAX_ENTITIES + 1) so that a full step of traffic (every boid
+// as a ghost and again as a migrant, plus both end markers) always fits and a
+// producer never waits on a consumer that is itself blocked pushing.
+typedef struct {
+  _Alignas(64) atomic_uint head; // producer
+  _Alignas(64) atomic_uint tail; // consumer
+  _Alignas(64) uint32_t capacity;
+} DecompRing_t;
+
+typedef struct {
+  pthread_barrier_t start;
+  pthread_barrier_t done;
+
+  int workers;
+  int quit;
+  float dt;
+
+  // Steering params, refreshed every step
+  float neighborRadius;
+  float separationRadius;
+  float alignWeight;
+  float cohesionWeight;
+  float separationWeight;
+  float maxSpeed;
+  float minSpeed;
+  float maxForce;
+  Vector3 boundsMin;
+  Vector3 boundsMax;
+
+  int count[MAX_DECOMP_WORKERS];
+} DecompControl_t;
+
+struct BoidsDecomp {
+  int workers;
+  pid_t pids[MAX_DECOMP_WORKERS];
+
+  void *base;
+  size_t size;
+
+  DecompControl_t *ctl;
+  DecompBoid_t *slabs;   // workers * MAX_ENTITIES
+  uint8_t *rings;        // workers * 2 * ringStride
+  size_t ringStride;
+
+  bool resync; // re-seed slabs from the ECS before the next step
+};
+
+// ------------------------------------------------------------
+// Segment helpers
+// ------------------------------------------------------------
+static size_t align_up(size_t v, size_t a) { return (v + a - 1) & ~(a - 1); }
+
+static DecompBoid_t *slabOf(BoidsDecomp_t *d, int w) {
+  return d->slabs + (size_t)w * MAX_ENTITIES;
+}
+
+static DecompRing_t *ringOf(BoidsDecomp_t *d, int w, int dir) {
+  return (DecompRing_t *)(d->rings + ((size_t)w * 2 + dir) * d->ringStride);
+}
+
+static DecompBoid_t *ringItems(DecompRing_t *r) {
+  return (DecompBoid_t *)((uint8_t *)r + align_up(sizeof(DecompRing_t), 64));
+}
+
+static void ringPush(DecompRing_t *r, const DecompBoid_t *b) {
+  unsigned h = atomic_load_explicit(&r->head, memory_order_relaxed);
+  while (h - atomic_load_explicit(&r->tail, memory_order_acquire) >=
+         r->capacity)
+    sched_yield();
+  ringItems(r)[h % r->capacity] = *b;
+  atomic_store_explicit(&r->head, h + 1, memory_order_release);
+}
+
+static void ringPushEnd(DecompRing_t *r) {
+  DecompBoid_t end = {.id = DECOMP_END_MARKER};
+  ringPush(r, &end);
+}
+
+// Blocks until an item is available. Returns false on the end marker.
+static bool ringPop(DecompRing_t *r, DecompBoid_t *out) {
+  unsigned t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  while (atomic_load_explicit(&r->head, memory_order_acquire) == t)
+    sched_yield();
+  *out = ringItems(r)[t % r->capacity];
+  atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+  return out->id != DECOMP_END_MARKER;
+}
+
+static int slabIndexForX(const DecompControl_t *ctl, float x) {
+  float w = (ctl->boundsMax.x - ctl->boundsMin.x) / (float)ctl->workers;
+  int s = (int)floorf((x - ctl->boundsMin.x) / w);
+  return clamp_int(s, 0, ctl->workers - 1);
+}
+
+// ------------------------------------------------------------
+// NUMA pinning (reads sysfs, no libnuma dependency)
+// ------------------------------------------------------------
+static bool readNodeCpus(int node, cpu_set_t *set) {
+  char path[96];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+           node);
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+
+  char buf[1024];
+  bool ok = fgets(buf, sizeof(buf), f) != NULL;
+  fclose(f);
+  if (!ok)
+    return false;
+
+  CPU_ZERO(set);
+  char *s = buf;
+  while (*s && *s != '\n') {
+    char *end;
+    long lo = strtol(s, &end, 10);
+    long hi = lo;
+    if (end == s)
+      break;
+    if (*end == '-')
+      hi = strtol(end + 1, &end, 10);
+    for (long c = lo; c <= hi && c < CPU_SETSIZE; c++)
+      CPU_SET((int)c, set);
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return CPU_COUNT(set) > 0;
+}
+
+static void pinWorkerToNode(int w) {
+  int nodes = 0;
+  cpu_set_t probe;
+  while (nodes < 256 && readNodeCpus(nodes, &probe))
+    nodes++;
+  if (nodes == 0)
+    return;
+
+  cpu_set_t set;
+  if (readNodeCpus(w % nodes, &set))
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+// ------------------------------------------------------------
+// Worker process
+// ------------------------------------------------------------
+typedef struct {
+  Vector3 *pos; // own boids first, then ghosts
+  Vector3 *vel;
+  Vector3 *nextVel;
+  int *head;
+  int *nextIdx;
+} DecompLocal_t;
+
+static void decompParamsToState(const DecompControl_t *ctl, GameState_t *gs) {
+  gs->neighborRadius = ctl->neighborRadius;
+  gs->separationRadius = ctl->separationRadius;
+  gs->alignWeight = ctl->alignWeight;
+  gs->cohesionWeight = ctl->cohesionWeight;
+  gs->separationWeight = ctl->separationWeight;
+  gs->maxSpeed = ctl->maxSpeed;
+  gs->minSpeed = ctl->minSpeed;
+  gs->maxForce = ctl->maxForce;
+  gs->boundsMin = ctl->boundsMin;
+  gs->boundsMax = ctl->boundsMax;
+}
+
+static void decompStep(BoidsDecomp_t *d, DecompLocal_t *L, GameState_t *gs,
+                       int w) {
+  DecompControl_t *ctl = d->ctl;
+  const int N = ctl->workers;
+  const int left = (w - 1 + N) % N;
+  const int right = (w + 1) % N;
+  const float dt = ctl->dt;
+  const float R = ctl->neighborRadius;
+
+  decompParamsToState(ctl, gs);
+
+  Vector3 bmin = ctl->boundsMin;
+  Vector3 bmax = ctl->boundsMax;
+  float slabW = (bmax.x - bmin.x) / (float)N;
+  float slabMin = bmin.x + slabW * (float)w;
+  float slabMax = (w == N - 1) ? bmax.x : slabMin + slabW;
+
+  DecompBoid_t *own = slabOf(d, w);
+  int n = ctl->count[w];
+
+  // ---- Ghosts out (borders are not periodic for neighbor search)
+  DecompRing_t *toLeft = ringOf(d, w, DECOMP_DIR_LEFT);
+  DecompRing_t *toRight = ringOf(d, w, DECOMP_DIR_RIGHT);
+
+  for (int i = 0; i < n; i++) {
+    if (w > 0 && own[i].pos.x < slabMin + R)
+      ringPush(toLeft, &own[i]);
+    if (w < N - 1 && own[i].pos.x >= slabMax - R)
+      ringPush(toRight, &own[i]);
+  }
+  ringPushEnd(toLeft);
+  ringPushEnd(toRight);
+
+  // ---- Local arrays: own boids, then ghosts
+  for (int i = 0; i < n; i++) {
+    L->pos[i] = own[i].pos;
+    L->vel[i] = own[i].vel;
+  }
+
+  int m = n;
+  DecompRing_t *fromLeft = ringOf(d, left, DECOMP_DIR_RIGHT);
+  DecompRing_t *fromRight = ringOf(d, right, DECOMP_DIR_LEFT);
+  DecompBoid_t b;
+  while (ringPop(fromLeft, &b)) {
+    if (m < MAX_ENTITIES) {
+      L->pos[m] = b.pos;
+      L->vel[m] = b.vel;
+      m++;
+    }
+  }
+  while (ringPop(fromRight, &b)) {
+    if (m < MAX_ENTITIES) {
+      L->pos[m] = b.pos;
+      L->vel[m] = b.vel;
+      m++;
+    }
+  }
+
+  // ---- Slab grid (slab extended by one neighbor radius on each side)
+  Vector3 gmin = (Vector3){slabMin - R, bmin.y, bmin.z};
+  Vector3 gmax = (Vector3){slabMax + R, bmax.y, bmax.z};
+  float ext = fmaxf(gmax.x - gmin.x, fmaxf(gmax.y - gmin.y, gmax.z - gmin.z));
+  float cellSize = fmaxf(R > 0.001f ? R : 1.0f, ext / (float)DECOMP_MAX_DIM);
+  float invCell = 1.0f / cellSize;
+
+  int dimX = clamp_int((int)ceilf((gmax.x - gmin.x) * invCell), 1,
+                       DECOMP_MAX_DIM);
+  int dimY = clamp_int((int)ceilf((gmax.y - gmin.y) * invCell), 1,
+                       DECOMP_MAX_DIM);
+  int dimZ = clamp_int((int)ceilf((gmax.z - gmin.z) * invCell), 1,
+                       DECOMP_MAX_DIM);
+
+  for (int c = 0; c < dimX * dimY * dimZ; c++)
+    L->head[c] = -1;
+
+  for (int i = 0; i < m; i++) {
+    Vector3 p = L->pos[i];
+    int ci = cellIndex(cellCoord(p.x, gmin.x, invCell, dimX),
+                       cellCoord(p.y, gmin.y, invCell, dimY),
+                       cellCoord(p.z, gmin.z, invCell, dimZ), dimX, dimY);
+    L->nextIdx[i] = L->head[ci];
+    L->head[ci] = i;
+  }
+
+  // ---- Steer own boids
+  const float neighborR2 = R * R;
+  const float sepR2 = ctl->separationRadius * ctl->separationRadius;
+
+  for (int i = 0; i < n; i++) {
+    Vector3 p = L->pos[i];
+    int cx = cellCoord(p.x, gmin.x, invCell, dimX);
+    int cy = cellCoord(p.y, gmin.y, invCell, dimY);
+    int cz = cellCoord(p.z, gmin.z, invCell, dimZ);
+
+    BoidAccum_t acc = {0};
+    for (int z2 = cz - 1; z2 <= cz + 1; z2++) {
+      if ((unsigned)z2 >= (unsigned)dimZ)
+        continue;
+      for (int y2 = cy - 1; y2 <= cy + 1; y2++) {
+        if ((unsigned)y2 >= (unsigned)dimY)
+          continue;
+        for (int x2 = cx - 1; x2 <= cx + 1; x2++) {
+          if ((unsigned)x2 >= (unsigned)dimX)
+            continue;
+          int ci = cellIndex(x2, y2, z2, dimX, dimY);
+          for (int j = L->head[ci]; j != -1; j = L->nextIdx[j]) {
+            if (j == i)
+              continue;
+            BoidAccumulate(&acc, p, L->pos[j], L->vel[j], neighborR2, sepR2);
+          }
+        }
+      }
+    }
+
+    L->nextVel[i] = BoidSteer(gs, &acc, p, L->vel[i], dt);
+  }
+
+  // Terrain was built before fork; each worker has its own copy
+  if (gs->terrainEnabled) {
+    TerrainAvoidParams_t tp = BoidTerrainParams(gs);
+    TerrainAvoidBatch(&gs->terrain, L->pos, L->nextVel, NULL, n, &tp, dt,
+                      false);
+  }
+
+  // ---- Integrate + migrants out
+  int kept = 0;
+  for (int i = 0; i < n; i++) {
+    DecompBoid_t nb = own[i];
+    nb.vel = L->nextVel[i];
+    nb.pos = BoidIntegrate(nb.pos, nb.vel, dt, bmin, bmax);
+    if (gs->terrainEnabled)
+      TerrainClampAbove(&gs->terrain, &nb.pos);
+
+    int target = slabIndexForX(ctl, nb.pos.x);
+    if (target == w) {
+      own[kept++] = nb;
+      continue;
+    }
+
+    // Shortest way round the periodic slab ring; a boid that skips more than
+    // one slab in a step is forwarded again on the next step.
+    int fwd = (target - w + N) % N;
+    ringPush(fwd <= N / 2 ? toRight : toLeft, &nb);
+  }
+  ringPushEnd(toLeft);
+  ringPushEnd(toRight);
+
+  // ---- Migrants in
+  while (ringPop(fromLeft, &b)) {
+    if (kept < MAX_ENTITIES)
+      own[kept++] = b;
+  }
+  while (ringPop(fromRight, &b)) {
+    if (kept < MAX_ENTITIES)
+      own[kept++] = b;
+  }
+
+  ctl->count[w] = kept;
+}
+
+static void decompWorkerMain(BoidsDecomp_t *d, GameState_t *gs, int w,
+                             bool pinNuma) {
+  if (pinNuma)
+    pinWorkerToNode(w);
+
+  // Allocated after pinning so first touch lands on the worker's node
+  DecompLocal_t L;
+  L.pos = malloc(sizeof(Vector3) * MAX_ENTITIES);
+  L.vel = malloc(sizeof(Vector3) * MAX_ENTITIES);
+  L.nextVel = malloc(sizeof(Vector3) * MAX_ENTITIES);
+  L.nextIdx = malloc(sizeof(int) * MAX_ENTITIES);
+  L.head = malloc(sizeof(int) * DECOMP_MAX_DIM * DECOMP_MAX_DIM *
+                  DECOMP_MAX_DIM);
+
+  if (!L.pos || !L.vel || !L.nextVel || !L.nextIdx || !L.head)
+    _exit(1);
+
+  for (;;) {
+    pthread_barrier_wait(&d->ctl->start);
+    if (d->ctl->quit)
+      break;
+    decompStep(d, &L, gs, w);
+    pthread_barrier_wait(&d->ctl->done);
+  }
+
+  // The process image is discarded; no GL/window teardown must run here.
+  _exit(0);
+}
+
+// ------------------------------------------------------------
+// Main process side
+// ------------------------------------------------------------
+static void decompScatter(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng) {
+  DecompControl_t *ctl = d->ctl;
+  for (int w = 0; w < d->workers; w++)
+    ctl->count[w] = 0;
+
+  for (int k = 0; k < gs->boidCount; k++) {
+    entity_t e = gs->boids[k];
+    int slot = GetEntitySlot(&eng->em, e);
+    if (slot < 0 || !eng->em.alive[slot])
+      continue;
+
+    Vector3 *p = (Vector3 *)getComponent(eng->actors, e, gs->reg.cid_pos);
+    Vector3 *v = (Vector3 *)getComponent(eng->actors, e, gs->reg.cid_vel);
+    if (!p || !v)
+      continue;
+
+    int w = slabIndexForX(ctl, p->x);
+    slabOf(d, w)[ctl->count[w]++] = (DecompBoid_t){e, *p, *v};
+  }
+
+  d->resync = false;
+}
+
+static void decompGather(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng) {
+  for (int w = 0; w < d->workers; w++) {
+    DecompBoid_t *own = slabOf(d, w);
+    for (int i = 0; i < d->ctl->count[w]; i++) {
+      Vector3 *p =
+          (Vector3 *)getComponent(eng->actors, own[i].id, gs->reg.cid_pos);
+      Vector3 *v =
+          (Vector3 *)getComponent(eng->actors, own[i].id, gs->reg.cid_vel);
+      if (!p || !v)
+        continue;
+      *p = own[i].pos;
+      *v = own[i].vel;
+    }
+  }
+}
+
+BoidsDecomp_t *BoidsDecompStart(GameState_t *gs, Engine_t *eng, int workers,
+                                bool pinNuma) {
+  if (workers < 2 || workers > MAX_DECOMP_WORKERS) {
+    TraceLog(LOG_WARNING, "DECOMP: worker count %d out of range [2, %d]",
+             workers, MAX_DECOMP_WORKERS);
+    return NULL;
+  }
+
+  float slabW = (gs->boundsMax.x - gs->boundsMin.x) / (float)workers;
+  if (slabW < gs->neighborRadius) {
+    TraceLog(LOG_WARNING,
+             "DECOMP: slab width %.2f is below the neighbor radius %.2f",
+             slabW, gs->neighborRadius);
+    return NULL;
+  }
+
+  BoidsDecomp_t *d = calloc(1, sizeof(BoidsDecomp_t));
+  if (!d)
+    return NULL;
+  d->workers = workers;
+
+  size_t ctlSize = align_up(sizeof(DecompControl_t), 64);
+  size_t slabSize =
+      align_up(sizeof(DecompBoid_t) * MAX_ENTITIES * (size_t)workers, 64);
+  d->ringStride = align_up(sizeof(DecompRing_t), 64) +
+                  align_up(sizeof(DecompBoid_t) * 2 * (MAX_ENTITIES + 1), 64);
+  d->size = ctlSize + slabSize + d->ringStride * 2 * (size_t)workers;
+
+  char name[64];
+  snprintf(name, sizeof(name), "/boids-decomp-%d", (int)getpid());
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    TraceLog(LOG_WARNING, "DECOMP: shm_open(%s) failed", name);
+    free(d);
+    return NULL;
+  }
+  // Only the mapping is needed; the name goes away immediately
+  shm_unlink(name);
+
+  if (ftruncate(fd, (off_t)d->size) != 0) {
+    close(fd);
+    free(d);
+    return NULL;
+  }
+
+  d->base = mmap(NULL, d->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (d->base == MAP_FAILED) {
+    TraceLog(LOG_WARNING, "DECOMP: mmap of %zu bytes failed", d->size);
+    free(d);
+    return NULL;
+  }
+
+  d->ctl = (DecompControl_t *)d->base;
+  d->slabs = (DecompBoid_t *)((uint8_t *)d->base + ctlSize);
+  d->rings = (uint8_t *)d->base + ctlSize + slabSize;
+
+  for (int w = 0; w < workers; w++) {
+    for (int dir = 0; dir < 2; dir++) {
+      DecompRing_t *r = ringOf(d, w, dir);
+      atomic_init(&r->head, 0);
+      atomic_init(&r->tail, 0);
+      r->capacity = 2 * (MAX_ENTITIES + 1);
+    }
+  }
+
+  pthread_barrierattr_t attr;
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_barrier_init(&d->ctl->start, &attr, (unsigned)workers + 1);
+  pthread_barrier_init(&d->ctl->done, &attr, (unsigned)workers + 1);
+  pthread_barrierattr_destroy(&attr);
+
+  d->ctl->workers = workers;
+  d->ctl->boundsMin = gs->boundsMin;
+  d->ctl->boundsMax = gs->boundsMax;
+  decompScatter(d, gs, eng);
+
+  for (int w = 0; w < workers; w++) {
+    pid_t pid = fork();
+    if (pid == 0)
+      decompWorkerMain(d, gs, w, pinNuma);
+    if (pid < 0) {
+      TraceLog(LOG_WARNING, "DECOMP: fork failed for worker %d", w);
+      // Workers already forked are parked on the start barrier; there is no
+      // clean way to release a partially joined barrier, so kill them.
+      for (int k = 0; k < w; k++) {
+        kill(d->pids[k], SIGKILL);
+        waitpid(d->pids[k], NULL, 0);
+      }
+      munmap(d->base, d->size);
+      free(d);
+      return NULL;
+    }
+    d->pids[w] = pid;
+  }
+
+  TraceLog(LOG_INFO, "DECOMP: %d slab workers, %.1f units per slab%s",
+           workers, slabW, pinNuma ? ", NUMA pinned" : "");
+  return d;
+}
+
+void SysBoidsUpdateDecomp(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                          float dt) {
+  DecompControl_t *ctl = d->ctl;
+
+  ctl->dt = dt;
+  ctl->neighborRadius = gs->neighborRadius;
+  ctl->separationRadius = gs->separationRadius;
+  ctl->alignWeight = gs->alignWeight;
+  ctl->cohesionWeight = gs->cohesionWeight;
+  ctl->separationWeight = gs->separationWeight;
+  ctl->maxSpeed = gs->maxSpeed;
+  ctl->minSpeed = gs->minSpeed;
+  ctl->maxForce = gs->maxForce;
+  ctl->boundsMin = gs->boundsMin;
+  ctl->boundsMax = gs->boundsMax;
+
+  if (d->resync)
+    decompScatter(d, gs, eng);
+
+  pthread_barrier_wait(&ctl->start);
+  pthread_barrier_wait(&ctl->done);
+
+  decompGather(d, gs, eng);
+  BoidsGridInvalidate(gs);
+}
+
+float BoidsDecompVerify(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                        float dt) {
+  int n = gs->boidCount;
+  Vector3 *snapP = malloc(sizeof(Vector3) * (size_t)n);
+  Vector3 *snapV = malloc(sizeof(Vector3) * (size_t)n);
+  Vector3 *decP = malloc(sizeof(Vector3) * (size_t)n);
+  Vector3 *decV = malloc(sizeof(Vector3) * (size_t)n);
+  float maxErr = -1.0f;
+
+  if (!snapP || !snapV || !decP || !decV)
+    goto out;
+
+  for (int k = 0; k < n; k++) {
+    Vector3 *p = getComponent(eng->actors, gs->boids[k], gs->reg.cid_pos);
+    Vector3 *v = getComponent(eng->actors, gs->boids[k], gs->reg.cid_vel);
+    snapP[k] = p ? *p : (Vector3){0};
+    snapV[k] = v ? *v : (Vector3){0};
+  }
+
+  // Decomposed step from the snapshot
+  d->resync = true;
+  SysBoidsUpdateDecomp(d, gs, eng, dt);
+  for (int k = 0; k < n; k++) {
+    Vector3 *p = getComponent(eng->actors, gs->boids[k], gs->reg.cid_pos);
+    Vector3 *v = getComponent(eng->actors, gs->boids[k], gs->reg.cid_vel);
+    decP[k] = p ? *p : (Vector3){0};
+    decV[k] = v ? *v : (Vector3){0};
+    if (p)
+      *p = snapP[k];
+    if (v)
+      *v = snapV[k];
+  }
+  BoidsGridInvalidate(gs);
+
+  // Reference step from the same snapshot
+  SysBoidsUpdate(gs, eng, dt);
+
+  maxErr = 0.0f;
+  for (int k = 0; k < n; k++) {
+    Vector3 *p = getComponent(eng->actors, gs->boids[k], gs->reg.cid_pos);
+    Vector3 *v = getComponent(eng->actors, gs->boids[k], gs->reg.cid_vel);
+    if (!p || !v)
+      continue;
+    // A wrapped boid lands on the opposite face in both runs; compare as is.
+    maxErr = fmaxf(maxErr, vlen(vsub(*p, decP[k])));
+    maxErr = fmaxf(maxErr, vlen(vsub(*v, decV[k])));
+  }
+
+  d->resync = true;
+
+out:
+  free(snapP);
+  free(snapV);
+  free(decP);
+  free(decV);
+  return maxErr;
+}
+
+void BoidsDecompStop(BoidsDecomp_t *d) {
+  if (!d)
+    return;
+
+  d->ctl->quit = 1;
+  pthread_barrier_wait(&d->ctl->start);
+  for (int w = 0; w < d->workers; w++)
+    waitpid(d->pids[w], NULL, 0);
+
+  pthread_barrier_destroy(&d->ctl->start);
+  pthread_barrier_destroy(&d->ctl->done);
+  munmap(d->base, d->size);
+  free(d);
+}
+
+#else // !__linux__
+
+BoidsDecomp_t *BoidsDecompStart(GameState_t *gs, Engine_t *eng, int workers,
+                                bool pinNuma) {
+  (void)gs;
+  (void)eng;
+  (void)workers;
+  (void)pinNuma;
+  TraceLog(LOG_WARNING, "DECOMP: multi-process mode is Linux only");
+  return NULL;
+}
+
+void SysBoidsUpdateDecomp(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                          float dt) {
+  (void)d;
+  SysBoidsUpdate(gs, eng, dt);
+}
+
+float BoidsDecompVerify(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                        float dt) {
+  (void)d;
+  (void)gs;
+  (void)eng;
+  (void)dt;
+  return -1.0f;
+}
+
+void BoidsDecompStop(BoidsDecomp_t *d) { (void)d; }
+
+#endif
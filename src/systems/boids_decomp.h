@@ -0,0 +1,37 @@
+#pragma once
+#include "../engine.h"
+#include "../game.h"
+#include <stdbool.h>
+
+// Multi-process domain decomposition for the boids update.
+//
+// boundsMin.x..boundsMax.x is cut into equal slabs, one forked worker process
+// per slab. Each worker owns the boids inside its slab. Every step the workers
+// swap ghost boids (within neighborRadius of a slab border) and migrate boids
+// that crossed a border through single-producer/single-consumer rings living
+// in one POSIX shared-memory segment. The main process only drives the step
+// barriers and gathers positions back into the ECS for drawing.
+
+#define MAX_DECOMP_WORKERS 64
+
+typedef struct BoidsDecomp BoidsDecomp_t;
+
+// Forks `workers` slab workers and hands them the current ECS boid state.
+// Must be called before the first OpenMP region runs in this process.
+// Returns NULL (and logs why) if the mode is unavailable.
+BoidsDecomp_t *BoidsDecompStart(GameState_t *gs, Engine_t *eng, int workers,
+                                bool pinNuma);
+
+// One simulation step across all workers; results land back in the ECS.
+void SysBoidsUpdateDecomp(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                          float dt);
+
+// Runs one decomposed step and one single-process step from the same state
+// and returns the largest position/velocity deviation between them. The ECS is
+// left holding the single-process result and the workers are re-seeded from
+// it.
+float BoidsDecompVerify(BoidsDecomp_t *d, GameState_t *gs, Engine_t *eng,
+                        float dt);
+
+// Stops and reaps the workers and releases the shared segment.
+void BoidsDecompStop(BoidsDecomp_t *d);
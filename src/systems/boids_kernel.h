@@ -0,0 +1,162 @@
+// boids_kernel.h
+// Shared math for every boids update path (single process + decomposed
+// workers). Everything is static inline so each translation unit gets its own
+// copy and the hot loops stay inlinable.
+
+#pragma once
+#include "../game.h"
+#include "raylib.h"
+#include <math.h>
+
+static inline float vlen(Vector3 v) {
+  return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+static inline Vector3 vclamp_mag(Vector3 v, float maxMag) {
+  float m = vlen(v);
+  if (m <= maxMag || m <= 0.00001f)
+    return v;
+  float s = maxMag / m;
+  return (Vector3){v.x * s, v.y * s, v.z * s};
+}
+
+static inline Vector3 vadd(Vector3 a, Vector3 b) {
+  return (Vector3){a.x + b.x, a.y + b.y, a.z + b.z};
+}
+static inline Vector3 vsub(Vector3 a, Vector3 b) {
+  return (Vector3){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+static inline Vector3 vscale(Vector3 a, float s) {
+  return (Vector3){a.x * s, a.y * s, a.z * s};
+}
+
+static inline int clamp_int(int v, int lo, int hi) {
+  if (v < lo)
+    return lo;
+  if (v > hi)
+    return hi;
+  return v;
+}
+
+// Convert world coordinate -> cell coordinate along one axis
+static inline int cellCoord(float p, float mn, float invCell, int dim) {
+  int c = (int)floorf((p - mn) * invCell);
+  return clamp_int(c, 0, dim - 1);
+}
+
+// Convert (cx,cy,cz) -> flattened 1D cell index
+static inline int cellIndex(int cx, int cy, int cz, int dimX, int dimY) {
+  return cx + cy * dimX + cz * (dimX * dimY);
+}
+
+// Per-boid neighbor sums gathered from the grid
+typedef struct {
+  Vector3 sumVel;
+  Vector3 sumPos;
+  Vector3 sumSep;
+  int neighborCount;
+  int sepCount;
+} BoidAccum_t;
+
+// Fold one neighbor (position pj, velocity vj) into the sums of boid at p
+static inline void BoidAccumulate(BoidAccum_t *a, Vector3 p, Vector3 pj,
+                                  Vector3 vj, float neighborR2, float sepR2) {
+  Vector3 d = vsub(pj, p);
+  float dist2 = d.x * d.x + d.y * d.y + d.z * d.z;
+  if (dist2 <= 0.0000001f)
+    return;
+
+  if (dist2 < neighborR2) {
+    a->sumVel = vadd(a->sumVel, vj);
+    a->sumPos = vadd(a->sumPos, pj);
+    a->neighborCount++;
+  }
+
+  if (dist2 < sepR2) {
+    float invDist = 1.0f / sqrtf(dist2);
+    a->sumSep = vadd(a->sumSep, vscale(d, -invDist));
+    a->sepCount++;
+  }
+}
+
+// Turn the neighbor sums into the boid's velocity for the next step
+static inline Vector3 BoidSteer(const GameState_t *gs, const BoidAccum_t *a,
+                                Vector3 p, Vector3 v, float dt) {
+  Vector3 accel = (Vector3){0};
+
+  if (a->neighborCount > 0) {
+    float invN = 1.0f / (float)a->neighborCount;
+
+    Vector3 avgVel = vscale(a->sumVel, invN);
+    Vector3 desiredA = (Vector3){0};
+    float avm = vlen(avgVel);
+    if (avm > 0.0001f)
+      desiredA = vscale(avgVel, gs->maxSpeed / avm);
+    Vector3 steerA = vsub(desiredA, v);
+    steerA = vclamp_mag(steerA, gs->maxForce);
+
+    Vector3 center = vscale(a->sumPos, invN);
+    Vector3 toCenter = vsub(center, p);
+    Vector3 desiredC = (Vector3){0};
+    float tcm = vlen(toCenter);
+    if (tcm > 0.0001f)
+      desiredC = vscale(toCenter, gs->maxSpeed / tcm);
+    Vector3 steerC = vsub(desiredC, v);
+    steerC = vclamp_mag(steerC, gs->maxForce);
+
+    Vector3 sumSep = a->sumSep;
+    if (a->sepCount > 0)
+      sumSep = vscale(sumSep, 1.0f / (float)a->sepCount);
+    Vector3 desiredS = (Vector3){0};
+    float sm = vlen(sumSep);
+    if (sm > 0.0001f)
+      desiredS = vscale(sumSep, gs->maxSpeed / sm);
+    Vector3 steerS = vsub(desiredS, v);
+    steerS = vclamp_mag(steerS, gs->maxForce);
+
+    accel = vadd(accel, vscale(steerA, gs->alignWeight));
+    accel = vadd(accel, vscale(steerC, gs->cohesionWeight));
+    accel = vadd(accel, vscale(steerS, gs->separationWeight));
+  }
+
+  v = vadd(v, vscale(accel, dt));
+  v = vclamp_mag(v, gs->maxSpeed);
+
+  float sp = vlen(v);
+  if (sp > 0.0001f && sp < gs->minSpeed) {
+    v = vscale(v, gs->minSpeed / sp);
+  }
+
+  return v;
+}
+
+static inline TerrainAvoidParams_t BoidTerrainParams(const GameState_t *gs) {
+  return (TerrainAvoidParams_t){
+      .lookahead = gs->terrainLookahead,
+      .clearance = gs->terrainClearance,
+      .weight = gs->terrainWeight,
+      .maxForce = gs->maxForce,
+      .maxSpeed = gs->maxSpeed,
+  };
+}
+
+// Advance a position by one step and wrap it back into the bounds box
+static inline Vector3 BoidIntegrate(Vector3 p, Vector3 v, float dt,
+                                    Vector3 bmin, Vector3 bmax) {
+  p = vadd(p, vscale(v, dt));
+
+  if (p.x < bmin.x)
+    p.x = bmax.x;
+  if (p.x > bmax.x)
+    p.x = bmin.x;
+  if (p.y < bmin.y)
+    p.y = bmax.y;
+  if (p.y > bmax.y)
+    p.y = bmin.y;
+  if (p.z < bmin.z)
+    p.z = bmax.z;
+  if (p.z > bmax.z)
+    p.z = bmin.z;
+
+  return p;
+}
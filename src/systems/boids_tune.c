@@ -0,0 +1,392 @@
+// boids_tune.c
+// Warm-up sweep over update shapes, cached per flock size/density
+// (see boids_tune.h).
+
+#define _POSIX_C_SOURCE 200809L
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "boids_tune.h"
+#include "../engine.h"
+#include "../game.h"
+#include "raylib.h"
+#include "systems.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TUNE_MAX_CANDIDATES 8
+
+typedef struct {
+  float cellScale;
+  int threads;
+  int schedule; // BoidsSchedule_t
+  int chunk;
+  bool incremental;
+} TuneConfig_t;
+
+typedef struct {
+  int hwThreads;
+  int count;
+  float density; // boids per cubic world unit
+  TuneConfig_t cfg;
+  float msPerFrame;
+} TuneCacheEntry_t;
+
+// Sweep order: the kernel and cell size change the most, so they go first
+typedef enum {
+  TUNE_KERNEL,
+  TUNE_CELL,
+  TUNE_THREADS,
+  TUNE_SCHEDULE,
+  TUNE_DIMS,
+} TuneDim_t;
+
+struct BoidsTuner {
+  char cachePath[512];
+  int hwThreads;
+  bool keepKernel; // gs->gridIncremental is the game's, not ours
+
+  // Applied whenever no sweep is running
+  TuneConfig_t current;
+  bool haveKey;
+  int tunedCount;
+  float tunedDensity;
+  unsigned ticks;
+
+  // Sweep state
+  bool tuning;
+  TuneDim_t dim;
+  TuneConfig_t cand[TUNE_MAX_CANDIDATES];
+  int candCount;
+  int candIdx;
+  int frame;
+  double samples[BOIDS_TUNE_FRAMES];
+  TuneConfig_t best;
+  double bestMs;
+
+  TuneCacheEntry_t cache[BOIDS_TUNE_MAX_CACHE];
+  int cacheCount;
+};
+
+static const char *kSchedNames[] = {"static", "dynamic", "guided"};
+
+static double nowMs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+// -----------------------------
+// Knobs <-> GameState_t
+// -----------------------------
+static TuneConfig_t readConfig(const GameState_t *gs) {
+  return (TuneConfig_t){
+      .cellScale = gs->gridCellScale > 0.0f ? gs->gridCellScale : 1.0f,
+      .threads = gs->simThreads,
+      .schedule = gs->simSchedule,
+      .chunk = gs->simChunk,
+      .incremental = gs->gridIncremental,
+  };
+}
+
+static void applyConfig(const BoidsTuner_t *t, GameState_t *gs,
+                        const TuneConfig_t *c) {
+  gs->gridCellScale = c->cellScale;
+  gs->simThreads = c->threads;
+  gs->simSchedule = c->schedule;
+  gs->simChunk = c->chunk;
+  if (!t->keepKernel)
+    gs->gridIncremental = c->incremental;
+}
+
+static void logConfig(const char *what, int count, float density,
+                      const TuneConfig_t *c, double ms) {
+  TraceLog(LOG_INFO,
+           "TUNE: %s for %d boids (density %.4f): cell x%.2f, %d threads, "
+           "%s/%d, %s grid, %.3f ms",
+           what, count, density, c->cellScale, c->threads,
+           kSchedNames[c->schedule < 0 || c->schedule > 2 ? 0 : c->schedule],
+           c->chunk, c->incremental ? "incremental" : "rebuilt", ms);
+}
+
+// Live boid count and density over the bounds box
+static void flockKey(const GameState_t *gs, const Engine_t *eng, int *count,
+                     float *density) {
+  int n = 0;
+  for (int i = 0; i < eng->em.count; i++)
+    n += eng->em.alive[i] != 0;
+
+  Vector3 mn = gs->boundsMin, mx = gs->boundsMax;
+  float vol = (mx.x - mn.x) * (mx.y - mn.y) * (mx.z - mn.z);
+  *count = n;
+  *density = vol > 0.0f ? (float)n / vol : 0.0f;
+}
+
+static bool shifted(float now, float then) {
+  return fabsf(now - then) > BOIDS_TUNE_SHIFT * fmaxf(then, 1e-12f);
+}
+
+// -----------------------------
+// Cache file
+// -----------------------------
+// One entry per line:
+//   hwThreads count density cellScale threads schedule chunk incremental ms
+static void cacheLoad(BoidsTuner_t *t) {
+  FILE *f = fopen(t->cachePath, "r");
+  if (!f)
+    return;
+
+  char line[256];
+  while (fgets(line, sizeof(line), f) && t->cacheCount < BOIDS_TUNE_MAX_CACHE) {
+    if (line[0] == '#')
+      continue;
+    TuneCacheEntry_t e;
+    int inc;
+    if (sscanf(line, "%d %d %f %f %d %d %d %d %f", &e.hwThreads, &e.count,
+               &e.density, &e.cfg.cellScale, &e.cfg.threads, &e.cfg.schedule,
+               &e.cfg.chunk, &inc, &e.msPerFrame) != 9)
+      continue;
+    if (e.cfg.cellScale <= 0.0f || e.cfg.threads < 0 || e.cfg.schedule < 0 ||
+        e.cfg.schedule > BOIDS_SCHED_GUIDED)
+      continue;
+    e.cfg.incremental = inc != 0;
+    t->cache[t->cacheCount++] = e;
+  }
+  fclose(f);
+
+  if (t->cacheCount > 0)
+    TraceLog(LOG_INFO, "TUNE: %d cached configurations in %s", t->cacheCount,
+             t->cachePath);
+}
+
+static void cacheSave(const BoidsTuner_t *t) {
+  FILE *f = fopen(t->cachePath, "w");
+  if (!f) {
+    TraceLog(LOG_WARNING, "TUNE: cannot write %s", t->cachePath);
+    return;
+  }
+  fprintf(f, "# boids tune cache v1: hwThreads count density cellScale "
+             "threads schedule chunk incremental ms\n");
+  for (int i = 0; i < t->cacheCount; i++) {
+    const TuneCacheEntry_t *e = &t->cache[i];
+    fprintf(f, "%d %d %.6g %.3f %d %d %d %d %.4f\n", e->hwThreads, e->count,
+            e->density, e->cfg.cellScale, e->cfg.threads, e->cfg.schedule,
+            e->cfg.chunk, e->cfg.incremental ? 1 : 0, e->msPerFrame);
+  }
+  fclose(f);
+}
+
+// Closest entry for this machine whose count and density are both within
+// BOIDS_TUNE_SHIFT, or -1. `kernel` >= 0 only matches entries measured with
+// that grid kernel (0 rebuilt, 1 incremental).
+static int cacheFind(const BoidsTuner_t *t, int count, float density,
+                     int kernel) {
+  int best = -1;
+  float bestDist = INFINITY;
+  for (int i = 0; i < t->cacheCount; i++) {
+    const TuneCacheEntry_t *e = &t->cache[i];
+    if (e->hwThreads != t->hwThreads || shifted((float)count, (float)e->count) ||
+        shifted(density, e->density))
+      continue;
+    if (kernel >= 0 && (int)e->cfg.incremental != kernel)
+      continue;
+    float d = fabsf(logf(((float)count + 1.0f) / ((float)e->count + 1.0f))) +
+              fabsf(logf((density + 1e-12f) / (e->density + 1e-12f)));
+    if (d < bestDist) {
+      bestDist = d;
+      best = i;
+    }
+  }
+  return best;
+}
+
+static void cachePut(BoidsTuner_t *t, const TuneCacheEntry_t *e) {
+  int i = cacheFind(t, e->count, e->density,
+                    t->keepKernel ? (int)e->cfg.incremental : -1);
+  if (i < 0) {
+    if (t->cacheCount == BOIDS_TUNE_MAX_CACHE) {
+      // Full: drop the oldest
+      memmove(&t->cache[0], &t->cache[1],
+              sizeof(t->cache[0]) * (BOIDS_TUNE_MAX_CACHE - 1));
+      t->cacheCount--;
+    }
+    i = t->cacheCount++;
+  }
+  t->cache[i] = *e;
+}
+
+// -----------------------------
+// Sweep
+// -----------------------------
+static void buildCandidates(BoidsTuner_t *t) {
+  TuneConfig_t base = t->best;
+  t->candCount = 0;
+  t->candIdx = 0;
+  t->frame = 0;
+
+#define ADD_CANDIDATE(field, value)                                            \
+  do {                                                                         \
+    TuneConfig_t c_ = base;                                                    \
+    c_.field = (value);                                                        \
+    t->cand[t->candCount++] = c_;                                              \
+  } while (0)
+
+  switch (t->dim) {
+  case TUNE_KERNEL:
+    ADD_CANDIDATE(incremental, false);
+    ADD_CANDIDATE(incremental, true);
+    break;
+  case TUNE_CELL: {
+    static const float scales[] = {0.5f, 0.75f, 1.0f, 1.5f, 2.0f};
+    for (int i = 0; i < 5; i++)
+      ADD_CANDIDATE(cellScale, scales[i]);
+    break;
+  }
+  case TUNE_THREADS:
+    for (int n = t->hwThreads; n >= 1 && t->candCount < TUNE_MAX_CANDIDATES;
+         n /= 2)
+      ADD_CANDIDATE(threads, n);
+    break;
+  case TUNE_SCHEDULE: {
+    static const int kinds[] = {BOIDS_SCHED_STATIC, BOIDS_SCHED_DYNAMIC,
+                                BOIDS_SCHED_DYNAMIC, BOIDS_SCHED_GUIDED};
+    static const int chunks[] = {0, 64, 512, 0};
+    for (int i = 0; i < 4; i++) {
+      TuneConfig_t c = base;
+      c.schedule = kinds[i];
+      c.chunk = chunks[i];
+      t->cand[t->candCount++] = c;
+    }
+    break;
+  }
+  default:
+    break;
+  }
+#undef ADD_CANDIDATE
+}
+
+static void startSweep(BoidsTuner_t *t, const GameState_t *gs) {
+  t->tuning = true;
+  t->dim = t->keepKernel ? TUNE_CELL : TUNE_KERNEL;
+  t->best = readConfig(gs);
+  if (t->best.threads <= 0)
+    t->best.threads = t->hwThreads;
+  t->bestMs = INFINITY;
+  buildCandidates(t);
+  TraceLog(LOG_INFO, "TUNE: sweeping update configurations for %d boids",
+           t->tunedCount);
+}
+
+static int cmpDouble(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Takes one timed frame of the current candidate and moves the sweep on
+static void sweepAdvance(BoidsTuner_t *t, double ms) {
+  t->samples[t->frame++] = ms;
+  if (t->frame < BOIDS_TUNE_FRAMES)
+    return;
+
+  // The first frame after a switch pays for grid rebuilds and cold caches
+  double s[BOIDS_TUNE_FRAMES - 1];
+  memcpy(s, t->samples + 1, sizeof(s));
+  qsort(s, BOIDS_TUNE_FRAMES - 1, sizeof(double), cmpDouble);
+  double median = s[(BOIDS_TUNE_FRAMES - 1) / 2];
+
+  // Every dimension re-measures the incumbent, so compare within it only
+  if (t->candIdx == 0 || median < t->bestMs) {
+    t->bestMs = median;
+    t->best = t->cand[t->candIdx];
+  }
+  t->frame = 0;
+
+  if (++t->candIdx < t->candCount)
+    return;
+
+  if (++t->dim < TUNE_DIMS) {
+    buildCandidates(t);
+    return;
+  }
+
+  t->tuning = false;
+  t->current = t->best;
+  logConfig("tuned", t->tunedCount, t->tunedDensity, &t->best, t->bestMs);
+
+  TuneCacheEntry_t e = {
+      .hwThreads = t->hwThreads,
+      .count = t->tunedCount,
+      .density = t->tunedDensity,
+      .cfg = t->best,
+      .msPerFrame = (float)t->bestMs,
+  };
+  cachePut(t, &e);
+  cacheSave(t);
+}
+
+// -----------------------------
+// Public API
+// -----------------------------
+BoidsTuner_t *BoidsTunerCreate(const char *cachePath, bool keepKernel) {
+  BoidsTuner_t *t = calloc(1, sizeof(BoidsTuner_t));
+  if (!t)
+    return NULL;
+  t->keepKernel = keepKernel;
+
+  snprintf(t->cachePath, sizeof(t->cachePath), "%s",
+           cachePath ? cachePath : BOIDS_TUNE_DEFAULT_CACHE);
+#ifdef _OPENMP
+  t->hwThreads = omp_get_max_threads();
+#else
+  t->hwThreads = 1;
+#endif
+
+  cacheLoad(t);
+  return t;
+}
+
+void SysBoidsUpdateTuned(BoidsTuner_t *t, GameState_t *gs, Engine_t *eng,
+                         float dt) {
+  if (!t->tuning && t->ticks++ % BOIDS_TUNE_CHECK_TICKS == 0) {
+    int count;
+    float density;
+    flockKey(gs, eng, &count, &density);
+
+    if (!t->haveKey || shifted((float)count, (float)t->tunedCount) ||
+        shifted(density, t->tunedDensity)) {
+      t->haveKey = true;
+      t->tunedCount = count;
+      t->tunedDensity = density;
+
+      int hit = cacheFind(t, count, density,
+                          t->keepKernel ? (int)gs->gridIncremental : -1);
+      if (hit >= 0) {
+        t->current = t->cache[hit].cfg;
+        logConfig("cached", count, density, &t->current,
+                  t->cache[hit].msPerFrame);
+      } else {
+        startSweep(t, gs);
+      }
+    }
+  }
+
+  if (!t->tuning) {
+    applyConfig(t, gs, &t->current);
+    SysBoidsUpdate(gs, eng, dt);
+    return;
+  }
+
+  applyConfig(t, gs, &t->cand[t->candIdx]);
+  double t0 = nowMs();
+  SysBoidsUpdate(gs, eng, dt);
+  sweepAdvance(t, nowMs() - t0);
+}
+
+bool BoidsTunerIsTuning(const BoidsTuner_t *t) { return t && t->tuning; }
+
+void BoidsTunerDestroy(BoidsTuner_t *t) { free(t); }
@@ -0,0 +1,43 @@
+#pragma once
+#include "../engine.h"
+#include "../game.h"
+#include <stdbool.h>
+
+// Runtime auto-tuner for the single-process boids update.
+//
+// The update shape is a handful of GameState_t knobs: grid cell size
+// (gridCellScale), OpenMP team size (simThreads), loop schedule
+// (simSchedule/simChunk) and grid kernel (gridIncremental: rebuild every
+// frame or migrate incrementally). While tuning, every update runs one
+// candidate and is timed; each candidate gets BOIDS_TUNE_FRAMES frames and the
+// median counts. Dimensions are swept one at a time (kernel, cell size,
+// threads, schedule), each keeping the best value found so far for the others.
+//
+// The winner is stored with the boid count and density it was measured at and
+// written to a cache file, so the next startup with a similar flock skips the
+// warm-up. When count or density drift by more than BOIDS_TUNE_SHIFT the
+// cache is consulted again, and on a miss the sweep reruns.
+//
+// With `keepKernel` the grid kernel the game chose (gs->gridIncremental, e.g.
+// from --grid-rebuild) is never swept or overwritten, and only cache entries
+// measured with that kernel match.
+
+#define BOIDS_TUNE_FRAMES 6
+#define BOIDS_TUNE_SHIFT 0.25f
+#define BOIDS_TUNE_CHECK_TICKS 60
+#define BOIDS_TUNE_MAX_CACHE 64
+#define BOIDS_TUNE_DEFAULT_CACHE "boids_tune.cache"
+
+typedef struct BoidsTuner BoidsTuner_t;
+
+// `cachePath` NULL = BOIDS_TUNE_DEFAULT_CACHE. The first tuned update either
+// takes a cached winner or starts the sweep.
+BoidsTuner_t *BoidsTunerCreate(const char *cachePath, bool keepKernel);
+
+// SysBoidsUpdate with the knobs the tuner currently wants
+void SysBoidsUpdateTuned(BoidsTuner_t *t, GameState_t *gs, Engine_t *eng,
+                         float dt);
+
+bool BoidsTunerIsTuning(const BoidsTuner_t *t);
+
+void BoidsTunerDestroy(BoidsTuner_t *t);
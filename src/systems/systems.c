@@ -9,129 +9,427 @@
 #include "raylib.h"
 #include "rlgl.h"
 #include "systems.h"
+#include "boids_kernel.h"
 #include <float.h>
 #include <math.h>
 #include <stdbool.h>
-
-static inline float vlen(Vector3 v) {
-  return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------
+// Grid setup
+// -----------------------------
+
+// Persistent grid for incremental mode, sized for the largest dims so a
+// param change only needs a rebuild, never a reallocation
+static BoidsGrid_t *gridAcquire(GameState_t *gs, Engine_t *eng) {
+  if (gs->grid)
+    return gs->grid;
+
+  Arena_t *a = &eng->persistent;
+  const size_t maxCells =
+      (size_t)BOIDS_GRID_MAX_DIM * BOIDS_GRID_MAX_DIM * BOIDS_GRID_MAX_DIM;
+  BoidsGrid_t *g = arena_alloc(a, sizeof(BoidsGrid_t), 0);
+  if (!g)
+    return NULL;
+  g->head = arena_alloc(a, sizeof(int) * maxCells, 0);
+  g->next = arena_alloc(a, sizeof(int) * MAX_ENTITIES, 0);
+  g->prev = arena_alloc(a, sizeof(int) * MAX_ENTITIES, 0);
+  g->cellOf = arena_alloc(a, sizeof(int) * MAX_ENTITIES, 0);
+  g->moves = arena_alloc(a, sizeof(BoidsGridMove_t) * MAX_ENTITIES, 0);
+  if (!g->head || !g->next || !g->prev || !g->cellOf || !g->moves)
+    return NULL;
+
+  gs->grid = g;
+  return g;
 }
 
-static inline Vector3 vclamp_mag(Vector3 v, float maxMag) {
-  float m = vlen(v);
-  if (m <= maxMag || m <= 0.00001f)
-    return v;
-  float s = maxMag / m;
-  return (Vector3){v.x * s, v.y * s, v.z * s};
+bool BoidsFrameBegin(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng) {
+  f->pos = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_pos);
+  f->vel = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_vel);
+  f->posS = &eng->actors->componentStore[gs->reg.cid_pos];
+  f->velS = &eng->actors->componentStore[gs->reg.cid_vel];
+
+  f->bmin = gs->boundsMin;
+  f->bmax = gs->boundsMax;
+
+  float sx = f->bmax.x - f->bmin.x;
+  float sy = f->bmax.y - f->bmin.y;
+  float sz = f->bmax.z - f->bmin.z;
+
+  // Cell size in units of the neighbor radius (gridCellScale, picked by the
+  // tuner), grown if needed so BOIDS_GRID_MAX_DIM cells still cover the box.
+  // The neighbor stencil then spans ceil(radius / cellSize) cells each way.
+  float radius = (gs->neighborRadius > 0.001f) ? gs->neighborRadius : 1.0f;
+  float scale = gs->gridCellScale > 0.0f ? gs->gridCellScale : 1.0f;
+  float cover = fmaxf(sx, fmaxf(sy, sz)) / (float)BOIDS_GRID_MAX_DIM;
+  f->cellSize = fmaxf(radius * scale, cover);
+  f->invCell = 1.0f / f->cellSize;
+  f->reach = clamp_int((int)ceilf(radius * f->invCell - 1e-4f), 1,
+                       BOIDS_GRID_MAX_DIM);
+
+  // Parallel loop shape for accumulate/integrate (schedule(runtime))
+#ifdef _OPENMP
+  f->threads = gs->simThreads > 0 ? gs->simThreads : omp_get_max_threads();
+  static const omp_sched_t kinds[] = {omp_sched_static, omp_sched_dynamic,
+                                      omp_sched_guided};
+  omp_set_schedule(kinds[clamp_int(gs->simSchedule, 0, 2)], gs->simChunk);
+#else
+  f->threads = 1;
+#endif
+
+  // Safety clamp (avoid insane dims if someone sets tiny radii)
+  f->dimX = clamp_int((int)ceilf(sx / f->cellSize), 1, BOIDS_GRID_MAX_DIM);
+  f->dimY = clamp_int((int)ceilf(sy / f->cellSize), 1, BOIDS_GRID_MAX_DIM);
+  f->dimZ = clamp_int((int)ceilf(sz / f->cellSize), 1, BOIDS_GRID_MAX_DIM);
+  f->cellCount = f->dimX * f->dimY * f->dimZ;
+
+  // Linked-list buckets: head[cell] -> entity index -> next[index]
+  // Scratch for this frame only, carved from the frame arena. Every buffer is
+  // written before it is read (grid build, LOD select, accumulate), so none
+  // of it is cleared.
+  f->scratch = &eng->frame;
+  f->scratchMark = arena_mark(f->scratch);
+  f->steer = NULL;
+
+  f->grid = gs->gridIncremental ? gridAcquire(gs, eng) : NULL;
+  if (f->grid) {
+    BoidsGrid_t *g = f->grid;
+    f->head = g->head;
+    f->nextIdx = g->next;
+    f->gridStale = !g->valid || g->layoutVersion != eng->em.layoutVersion ||
+                   g->entityCount != eng->em.count ||
+                   g->cellSize != f->cellSize || g->dimX != f->dimX ||
+                   g->dimY != f->dimY || g->dimZ != f->dimZ ||
+                   memcmp(&g->bmin, &f->bmin, sizeof(Vector3)) != 0 ||
+                   memcmp(&g->bmax, &f->bmax, sizeof(Vector3)) != 0;
+  } else {
+    BoidsGridInvalidate(gs); // its positions go stale while unused
+    f->head =
+        arena_alloc_uninit(f->scratch, sizeof(int) * (size_t)f->cellCount, 0);
+    f->nextIdx =
+        arena_alloc_uninit(f->scratch, sizeof(int) * MAX_ENTITIES, 0);
+    f->gridStale = true;
+  }
+
+  f->nextVel =
+      arena_alloc_uninit(f->scratch, sizeof(Vector3) * MAX_ENTITIES, 0);
+  if (!f->head || !f->nextIdx || !f->nextVel) {
+    arena_release(f->scratch, f->scratchMark);
+    return false;
+  }
+  return true;
 }
 
-static inline Vector3 vadd(Vector3 a, Vector3 b) {
-  return (Vector3){a.x + b.x, a.y + b.y, a.z + b.z};
+void BoidsFrameEnd(BoidsFrame_t *f) {
+  arena_release(f->scratch, f->scratchMark);
 }
-static inline Vector3 vsub(Vector3 a, Vector3 b) {
-  return (Vector3){a.x - b.x, a.y - b.y, a.z - b.z};
+
+static inline bool boidActive(const BoidsFrame_t *f, const Engine_t *eng,
+                              int i) {
+  return eng->em.alive[i] && f->posS->occupied[i] && f->velS->occupied[i];
 }
-static inline Vector3 vscale(Vector3 a, float s) {
-  return (Vector3){a.x * s, a.y * s, a.z * s};
+
+static inline int boidCell(const BoidsFrame_t *f, Vector3 p) {
+  int cx = cellCoord(p.x, f->bmin.x, f->invCell, f->dimX);
+  int cy = cellCoord(p.y, f->bmin.y, f->invCell, f->dimY);
+  int cz = cellCoord(p.z, f->bmin.z, f->invCell, f->dimZ);
+  return cellIndex(cx, cy, cz, f->dimX, f->dimY);
 }
 
-static inline int clamp_int(int v, int lo, int hi) {
-  if (v < lo)
-    return lo;
-  if (v > hi)
-    return hi;
-  return v;
+void BoidsGridBuild(BoidsFrame_t *f, Engine_t *eng) {
+  // Incremental mode: last frame's integrate already migrated every boid
+  if (!f->gridStale)
+    return;
+
+  const Vector3 *pos = f->pos;
+  int *head = f->head;
+  int *nextIdx = f->nextIdx;
+  BoidsGrid_t *g = f->grid;
+
+  // Init heads
+  for (int c = 0; c < f->cellCount; c++)
+    head[c] = -1;
+
+  // Build grid: insert each alive+occupied boid into its cell. Live slots are
+  // dense in [0, em.count); nothing links to the slots past it.
+  const int n = eng->em.count;
+  for (int i = 0; i < n; i++) {
+    nextIdx[i] = -1;
+    if (g)
+      g->cellOf[i] = -1;
+    if (!boidActive(f, eng, i))
+      continue;
+
+    int ci = boidCell(f, pos[i]);
+    nextIdx[i] = head[ci];
+    head[ci] = i;
+
+    if (g) {
+      g->prev[i] = -1;
+      if (nextIdx[i] != -1)
+        g->prev[nextIdx[i]] = i;
+      g->cellOf[i] = ci;
+    }
+  }
+
+  if (g) {
+    g->valid = true;
+    g->layoutVersion = eng->em.layoutVersion;
+    g->entityCount = eng->em.count;
+    g->cellSize = f->cellSize;
+    g->bmin = f->bmin;
+    g->bmax = f->bmax;
+    g->dimX = f->dimX;
+    g->dimY = f->dimY;
+    g->dimZ = f->dimZ;
+    g->moveCount = 0;
+    g->rebuilds++;
+  }
 }
 
-// Convert world coordinate -> cell coordinate along one axis
-static inline int cellCoord(float p, float mn, float invCell, int dim) {
-  int c = (int)floorf((p - mn) * invCell);
-  return clamp_int(c, 0, dim - 1);
+void BoidsGridInvalidate(GameState_t *gs) {
+  if (gs->grid)
+    gs->grid->valid = false;
 }
 
-// Convert (cx,cy,cz) -> flattened 1D cell index
-static inline int cellIndex(int cx, int cy, int cz, int dimX, int dimY) {
-  return cx + cy * dimX + cz * (dimX * dimY);
+static int moveCmpSlot(const void *a, const void *b) {
+  return ((const BoidsGridMove_t *)a)->slot - ((const BoidsGridMove_t *)b)->slot;
 }
 
-void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt) {
-  Vector3 *pos = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_pos);
-  Vector3 *vel = (Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_vel);
+// Applies the cell changes recorded by BoidsIntegrate. Unlinking only touches
+// the old cell's list and linking only the new cell's, so each thread takes
+// the moves whose cell it owns (cell % threads): first every unlink, then,
+// after a barrier, every link.
+static void gridMigrate(BoidsGrid_t *g, int threads) {
+  const int n = g->moveCount;
+  g->lastMoves = n;
+  g->moveCount = 0;
+  if (n == 0)
+    return;
 
-  ComponentStorage_t *posS = &eng->actors->componentStore[gs->reg.cid_pos];
-  ComponentStorage_t *velS = &eng->actors->componentStore[gs->reg.cid_vel];
+  // Moves were appended in whatever order threads finished; sort by slot so
+  // list order (and with it the float summation order) is reproducible
+  qsort(g->moves, (size_t)n, sizeof(BoidsGridMove_t), moveCmpSlot);
 
-  // -----------------------------
-  // Grid setup
-  // -----------------------------
-  // Choose cell size ~ neighbor radius (typical choice)
-  const float cellSize =
-      (gs->neighborRadius > 0.001f) ? gs->neighborRadius : 1.0f;
+  int *head = g->head, *next = g->next, *prev = g->prev, *cellOf = g->cellOf;
+  const BoidsGridMove_t *moves = g->moves;
 
-  Vector3 bmin = gs->boundsMin;
-  Vector3 bmax = gs->boundsMax;
+#ifdef _OPENMP
+#pragma omp parallel if (n > 2048) num_threads(threads)
+#endif
+  {
+#ifdef _OPENMP
+    const int t = omp_get_thread_num(), nt = omp_get_num_threads();
+#else
+    const int t = 0, nt = 1;
+#endif
+    for (int k = 0; k < n; k++) {
+      int i = moves[k].slot;
+      int c = cellOf[i];
+      if (c % nt != t)
+        continue;
+      if (prev[i] != -1)
+        next[prev[i]] = next[i];
+      else
+        head[c] = next[i];
+      if (next[i] != -1)
+        prev[next[i]] = prev[i];
+    }
 
-  float sx = bmax.x - bmin.x;
-  float sy = bmax.y - bmin.y;
-  float sz = bmax.z - bmin.z;
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
 
-  int dimX = (int)ceilf(sx / cellSize);
-  int dimY = (int)ceilf(sy / cellSize);
-  int dimZ = (int)ceilf(sz / cellSize);
+    for (int k = 0; k < n; k++) {
+      int i = moves[k].slot;
+      int c = moves[k].cell;
+      if (c % nt != t)
+        continue;
+      prev[i] = -1;
+      next[i] = head[c];
+      if (head[c] != -1)
+        prev[head[c]] = i;
+      head[c] = i;
+      cellOf[i] = c;
+    }
+  }
+}
 
-  // Safety clamp (avoid insane dims if someone sets tiny radii)
-  // With MAX_ENTITIES=512 you don't want gigantic grids.
-  if (dimX < 1)
-    dimX = 1;
-  if (dimX > 64)
-    dimX = 64;
-  if (dimY < 1)
-    dimY = 1;
-  if (dimY > 64)
-    dimY = 64;
-  if (dimZ < 1)
-    dimZ = 1;
-  if (dimZ > 64)
-    dimZ = 64;
-
-  const int cellCount = dimX * dimY * dimZ;
+void BoidsGridMigrate(BoidsFrame_t *f) {
+  if (f->grid)
+    gridMigrate(f->grid, f->threads);
+}
 
-  // Linked-list buckets: head[cell] -> entity index -> next[index]
-  // NOTE: cellCount varies with parameters; allocate with a conservative max.
-  // 64^3 = 262144 ints (fine).
-  static int head[64 * 64 * 64];
-  static int nextIdx[MAX_ENTITIES];
+// -----------------------------
+// Distance LOD
+// -----------------------------
+static inline int lodTier(const BoidsLod_t *lod, float dist2) {
+  for (int t = 0; t < lod->tierCount - 1; t++) {
+    float d = lod->tiers[t].maxDist;
+    if (dist2 <= d * d)
+      return t;
+  }
+  return lod->tierCount - 1;
+}
 
-  // Init heads
-  for (int c = 0; c < cellCount; c++)
-    head[c] = -1;
+// Stretches the far tiers' intervals so that the expected number of steering
+// evaluations this tick fits lod->steerBudget. The nearest tier is never
+// stretched.
+static void lodApplyBudget(BoidsLod_t *lod) {
+  for (int t = 0; t < lod->tierCount; t++)
+    lod->tierInterval[t] = lod->tiers[t].interval;
+
+  if (lod->steerBudget <= 0 || lod->tierCount < 2)
+    return;
+
+  float nearCost = (float)lod->tierBoids[0] / (float)lod->tierInterval[0];
+  float farCost = 0.0f;
+  for (int t = 1; t < lod->tierCount; t++)
+    farCost += (float)lod->tierBoids[t] / (float)lod->tierInterval[t];
+
+  float avail = (float)lod->steerBudget - nearCost;
+  if (farCost <= avail)
+    return;
+
+  float stretch = avail > 1.0f ? farCost / avail : (float)BOIDS_LOD_MAX_INTERVAL;
+  for (int t = 1; t < lod->tierCount; t++) {
+    int k = (int)ceilf((float)lod->tierInterval[t] * stretch);
+    lod->tierInterval[t] = clamp_int(k, 1, BOIDS_LOD_MAX_INTERVAL);
+  }
+}
 
-  const float invCell = 1.0f / cellSize;
+void BoidsLodSelect(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng) {
+  BoidsLod_t *lod = &gs->lod;
+  f->steer = NULL;
+  if (!lod->enabled || lod->tierCount < 1)
+    return;
 
-  // Build grid: insert each alive+occupied boid into its cell
-  for (int i = 0; i < MAX_ENTITIES; i++) {
-    nextIdx[i] = -1;
-    if (!eng->em.alive[i])
+  uint8_t *steer = arena_alloc_uninit(f->scratch, MAX_ENTITIES, 0);
+  if (!steer)
+    return; // fall back to full fidelity
+
+  const Vector3 *pos = f->pos;
+  const Vector3 eye = gs->cam.position;
+  const int tierCount = lod->tierCount;
+  const int n = eng->em.count;
+
+  // Pass 1: bucket by camera distance (steer[i] = tier + 1, 0 = inactive)
+  int counts[BOIDS_LOD_MAX_TIERS] = {0};
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : counts[:BOIDS_LOD_MAX_TIERS])
+#endif
+  for (int i = 0; i < n; i++) {
+    if (!boidActive(f, eng, i)) {
+      steer[i] = 0;
       continue;
-    if (!posS->occupied[i] || !velS->occupied[i])
+    }
+    Vector3 d = vsub(pos[i], eye);
+    int t = lodTier(lod, d.x * d.x + d.y * d.y + d.z * d.z);
+    steer[i] = (uint8_t)(t + 1);
+    counts[t]++;
+  }
+
+  for (int t = 0; t < BOIDS_LOD_MAX_TIERS; t++)
+    lod->tierBoids[t] = t < tierCount ? counts[t] : 0;
+  lodApplyBudget(lod);
+
+  // Pass 2: a boid in a tier with interval k steers on the ticks where
+  // handle % k == tick % k, so each tick handles one slice of 1/k of the tier
+  // (keyed by handle so storage reordering does not shift a boid's slice)
+  int intervals[BOIDS_LOD_MAX_TIERS];
+  for (int t = 0; t < BOIDS_LOD_MAX_TIERS; t++)
+    intervals[t] = t < tierCount ? lod->tierInterval[t] : 1;
+  const unsigned tick = lod->tick;
+  const int32_t *handleOf = eng->em.handleOf;
+
+  int steered[BOIDS_LOD_MAX_TIERS] = {0};
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : steered[:BOIDS_LOD_MAX_TIERS])
+#endif
+  for (int i = 0; i < n; i++) {
+    if (!steer[i])
       continue;
+    int t = steer[i] - 1;
+    unsigned k = (unsigned)intervals[t];
+    if ((unsigned)handleOf[i] % k == tick % k) {
+      steer[i] = (uint8_t)k;
+      steered[t]++;
+    } else {
+      steer[i] = 0;
+    }
+  }
 
-    Vector3 p = pos[i];
-    int cx = cellCoord(p.x, bmin.x, invCell, dimX);
-    int cy = cellCoord(p.y, bmin.y, invCell, dimY);
-    int cz = cellCoord(p.z, bmin.z, invCell, dimZ);
+  for (int t = 0; t < BOIDS_LOD_MAX_TIERS; t++)
+    lod->tierSteered[t] = t < tierCount ? steered[t] : 0;
+  lod->tick++;
 
-    int ci = cellIndex(cx, cy, cz, dimX, dimY);
-    nextIdx[i] = head[ci];
-    head[ci] = i;
+  f->steer = steer;
+}
+
+bool BoidsLodParseTiers(BoidsLod_t *lod, const char *spec) {
+  BoidsLodTier_t tiers[BOIDS_LOD_MAX_TIERS];
+  int count = 0;
+  const char *s = spec;
+
+  while (s && *s) {
+    if (count == BOIDS_LOD_MAX_TIERS)
+      return false;
+
+    char *end;
+    float dist;
+    if (strncmp(s, "inf", 3) == 0) {
+      dist = INFINITY;
+      end = (char *)s + 3;
+    } else {
+      dist = strtof(s, &end);
+    }
+    if (end == s || *end != ':' || !(dist > 0.0f))
+      return false;
+    if (count > 0 && dist <= tiers[count - 1].maxDist)
+      return false;
+
+    s = end + 1;
+    long every = strtol(s, &end, 10);
+    if (end == s || every < 1 || every > BOIDS_LOD_MAX_INTERVAL)
+      return false;
+
+    tiers[count++] = (BoidsLodTier_t){dist, (int)every};
+
+    s = end;
+    if (*s == ',')
+      s++;
+    else if (*s)
+      return false;
   }
 
-  // -----------------------------
-  // Boids update
-  // -----------------------------
-  static Vector3 nextVel[MAX_ENTITIES];
+  if (count == 0)
+    return false;
+
+  memcpy(lod->tiers, tiers, sizeof(tiers[0]) * (size_t)count);
+  lod->tierCount = count;
+  return true;
+}
 
-  for (int i = 0; i < MAX_ENTITIES; i++)
+// -----------------------------
+// Boids update
+// -----------------------------
+void BoidsAccumulate(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng,
+                     float dt) {
+  const Vector3 *pos = f->pos;
+  const Vector3 *vel = f->vel;
+  const int *head = f->head;
+  const int *nextIdx = f->nextIdx;
+  Vector3 *nextVel = f->nextVel;
+  const uint8_t *steer = f->steer;
+
+  const Vector3 bmin = f->bmin;
+  const float invCell = f->invCell;
+  const int dimX = f->dimX, dimY = f->dimY, dimZ = f->dimZ;
+  const int reach = f->reach;
+  const int n = eng->em.count;
+
+  for (int i = 0; i < n; i++)
     nextVel[i] = vel[i];
 
   const float neighborR = gs->neighborRadius;
@@ -141,12 +439,13 @@ void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt) {
   const float sepR2 = sepR * sepR;
 
 #ifdef _OPENMP
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for schedule(runtime) num_threads(f->threads)
 #endif
-  for (int i = 0; i < MAX_ENTITIES; i++) {
-    if (!eng->em.alive[i])
+  for (int i = 0; i < n; i++) {
+    if (!boidActive(f, eng, i))
       continue;
-    if (!posS->occupied[i] || !velS->occupied[i])
+    // LOD: skipped boids keep their velocity (nextVel already holds it)
+    if (steer && !steer[i])
       continue;
 
     Vector3 p = pos[i];
@@ -156,23 +455,19 @@ void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt) {
     int cy = cellCoord(p.y, bmin.y, invCell, dimY);
     int cz = cellCoord(p.z, bmin.z, invCell, dimZ);
 
-    Vector3 sumVel = (Vector3){0};
-    Vector3 sumPos = (Vector3){0};
-    Vector3 sumSep = (Vector3){0};
-    int neighborCount = 0;
-    int sepCount = 0;
+    BoidAccum_t acc = {0};
 
-    for (int dz = -1; dz <= 1; dz++) {
+    for (int dz = -reach; dz <= reach; dz++) {
       int z2 = cz + dz;
       if ((unsigned)z2 >= (unsigned)dimZ)
         continue;
 
-      for (int dy = -1; dy <= 1; dy++) {
+      for (int dy = -reach; dy <= reach; dy++) {
         int y2 = cy + dy;
         if ((unsigned)y2 >= (unsigned)dimY)
           continue;
 
-        for (int dx = -1; dx <= 1; dx++) {
+        for (int dx = -reach; dx <= reach; dx++) {
           int x2 = cx + dx;
           if ((unsigned)x2 >= (unsigned)dimX)
             continue;
@@ -182,100 +477,173 @@ void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt) {
           for (int j = head[ci]; j != -1; j = nextIdx[j]) {
             if (j == i)
               continue;
-
-            Vector3 d = vsub(pos[j], p);
-            float dist2 = d.x * d.x + d.y * d.y + d.z * d.z;
-            if (dist2 <= 0.0000001f)
-              continue;
-
-            if (dist2 < neighborR2) {
-              sumVel = vadd(sumVel, vel[j]);
-              sumPos = vadd(sumPos, pos[j]);
-              neighborCount++;
-            }
-
-            if (dist2 < sepR2) {
-              float invDist = 1.0f / sqrtf(dist2);
-              sumSep = vadd(sumSep, vscale(d, -invDist));
-              sepCount++;
-            }
+            BoidAccumulate(&acc, p, pos[j], vel[j], neighborR2, sepR2);
           }
         }
       }
     }
 
-    Vector3 accel = (Vector3){0};
-
-    if (neighborCount > 0) {
-      float invN = 1.0f / (float)neighborCount;
-
-      Vector3 avgVel = vscale(sumVel, invN);
-      Vector3 desiredA = (Vector3){0};
-      float avm = vlen(avgVel);
-      if (avm > 0.0001f)
-        desiredA = vscale(avgVel, gs->maxSpeed / avm);
-      Vector3 steerA = vsub(desiredA, v);
-      steerA = vclamp_mag(steerA, gs->maxForce);
-
-      Vector3 center = vscale(sumPos, invN);
-      Vector3 toCenter = vsub(center, p);
-      Vector3 desiredC = (Vector3){0};
-      float tcm = vlen(toCenter);
-      if (tcm > 0.0001f)
-        desiredC = vscale(toCenter, gs->maxSpeed / tcm);
-      Vector3 steerC = vsub(desiredC, v);
-      steerC = vclamp_mag(steerC, gs->maxForce);
-
-      if (sepCount > 0)
-        sumSep = vscale(sumSep, 1.0f / (float)sepCount);
-      Vector3 desiredS = (Vector3){0};
-      float sm = vlen(sumSep);
-      if (sm > 0.0001f)
-        desiredS = vscale(sumSep, gs->maxSpeed / sm);
-      Vector3 steerS = vsub(desiredS, v);
-      steerS = vclamp_mag(steerS, gs->maxForce);
-
-      accel = vadd(accel, vscale(steerA, gs->alignWeight));
-      accel = vadd(accel, vscale(steerC, gs->cohesionWeight));
-      accel = vadd(accel, vscale(steerS, gs->separationWeight));
-    }
+    // Steering recomputed every k ticks covers all k of them
+    float steerDt = steer ? dt * (float)steer[i] : dt;
+    v = BoidSteer(gs, &acc, p, v, steerDt);
 
-    v = vadd(v, vscale(accel, dt));
-    v = vclamp_mag(v, gs->maxSpeed);
+    nextVel[i] = v; // each thread writes a unique i -> safe
+  }
 
-    float sp = vlen(v);
-    if (sp > 0.0001f && sp < gs->minSpeed) {
-      v = vscale(v, gs->minSpeed / sp);
-    }
+  // Ground avoidance: most boids are rejected by the pyramid test. Runs for
+  // every boid each tick, LOD or not, so dead-reckoned far boids still pull
+  // up instead of sliding along the clamp until their next steering tick.
+  if (gs->terrainEnabled) {
+    TerrainAvoidParams_t tp = BoidTerrainParams(gs);
+    TerrainAvoidBatch(&gs->terrain, pos, nextVel, eng->em.alive, n, &tp, dt,
+                      true);
+  }
+}
 
-    nextVel[i] = v; // each thread writes a unique i -> safe
+void BoidsIntegrate(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng,
+                    float dt) {
+  Vector3 *pos = f->pos;
+  Vector3 *vel = f->vel;
+  const Vector3 *nextVel = f->nextVel;
+  const Vector3 bmin = f->bmin;
+  const Vector3 bmax = f->bmax;
+  BoidsGrid_t *g = f->grid;
+  const int n = eng->em.count;
+
+  // Integrate and rebin in one pass: positions are touched once, and boids
+  // that crossed into another cell are queued for BoidsGridMigrate
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) num_threads(f->threads)
+#endif
+  for (int i = 0; i < n; i++) {
+    if (!boidActive(f, eng, i))
+      continue;
+
+    vel[i] = nextVel[i];
+    Vector3 p = BoidIntegrate(pos[i], vel[i], dt, bmin, bmax);
+    if (gs->terrainEnabled)
+      TerrainClampAbove(&gs->terrain, &p);
+    pos[i] = p;
+
+    if (g) {
+      int c = boidCell(f, p);
+      if (c != g->cellOf[i]) {
+        int k;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+        k = g->moveCount++;
+        g->moves[k] = (BoidsGridMove_t){i, c};
+      }
+    }
   }
+}
+
+// -----------------------------
+// Ground collisions
+// -----------------------------
+static inline uint32_t hash32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+  return x;
+}
+
+static inline float hash01(uint32_t *state) {
+  *state = hash32(*state + 0x9E3779B9u);
+  return (float)(*state >> 8) * (1.0f / 16777216.0f);
+}
+
+void SysBoidsGroundCollisions(GameState_t *gs, Engine_t *eng) {
+  if (!gs->groundKills || !gs->terrainEnabled)
+    return;
+
+  const Vector3 *pos =
+      (const Vector3 *)GetComponentArray(eng->actors, gs->reg.cid_pos);
+  const bool *posOcc = eng->actors->componentStore[gs->reg.cid_pos].occupied;
+  const int32_t *handleOf = eng->em.handleOf;
+  EntityCommands_t *cmd = eng->commands;
+  const Vector3 bmin = gs->boundsMin, bmax = gs->boundsMax;
+  const unsigned tick = gs->groundTick++;
+  int kills = 0;
 
 #ifdef _OPENMP
-#pragma omp parallel for schedule(static)
+#pragma omp parallel for schedule(static) reduction(+ : kills)
 #endif
-  for (int i = 0; i < MAX_ENTITIES; i++) {
-    if (!eng->em.alive[i])
+  for (int i = 0; i < eng->em.count; i++) {
+    if (!eng->em.alive[i] || !posOcc[i])
       continue;
-    if (!posS->occupied[i] || !velS->occupied[i])
+    // Integrate clamps boids onto the surface, so touching = at the surface
+    Vector3 p = pos[i];
+    if (p.y > TerrainHeightAt(&gs->terrain, p.x, p.z) + 0.01f)
       continue;
 
-    vel[i] = nextVel[i];
-    pos[i] = vadd(pos[i], vscale(vel[i], dt));
-
-    if (pos[i].x < bmin.x)
-      pos[i].x = bmax.x;
-    if (pos[i].x > bmax.x)
-      pos[i].x = bmin.x;
-    if (pos[i].y < bmin.y)
-      pos[i].y = bmax.y;
-    if (pos[i].y > bmax.y)
-      pos[i].y = bmin.y;
-    if (pos[i].z < bmin.z)
-      pos[i].z = bmax.z;
-    if (pos[i].z > bmax.z)
-      pos[i].z = bmin.z;
+    entity_t dead = MakeEntityID(ET_ACTOR, handleOf[i]);
+    commands_kill(cmd, dead);
+
+    // Replacement somewhere in the top quarter of the box
+    uint32_t rng = (uint32_t)handleOf[i] * 2654435761u ^ tick;
+    Vector3 np = {bmin.x + (bmax.x - bmin.x) * hash01(&rng),
+                  bmax.y - (bmax.y - bmin.y) * 0.25f * hash01(&rng),
+                  bmin.z + (bmax.z - bmin.z) * hash01(&rng)};
+    Vector3 nv = {(hash01(&rng) * 2.0f - 1.0f) * gs->minSpeed,
+                  0.0f,
+                  (hash01(&rng) * 2.0f - 1.0f) * gs->minSpeed};
+
+    entity_t born = commands_spawn(cmd, ET_ACTOR);
+    commands_add(cmd, born, gs->reg.cid_pos, &np, sizeof(np));
+    commands_add(cmd, born, gs->reg.cid_vel, &nv, sizeof(nv));
+    kills++;
   }
+
+  gs->groundKillsTotal += kills;
+}
+
+void SysBoidsReorder(GameState_t *gs, Engine_t *eng) {
+  BoidsReorder_t *ro = &gs->reorder;
+  if (!ro->enabled)
+    return;
+
+  const int samples = 4096;
+  ro->ticks++;
+
+  // First call: spawn order is random in space, reorder right away
+  bool due = ro->reorders == 0;
+  if (!due && ro->period > 0 && ro->ticks >= (unsigned)ro->period)
+    due = true;
+  if (!due && ro->checkInterval > 0 &&
+      ro->ticks % (unsigned)ro->checkInterval == 0) {
+    float gap = measureStorageLocality(&eng->em, eng->actors, gs->reg.cid_pos,
+                                       samples);
+    due = ro->sortedGap > 0.0f && gap > ro->sortedGap * ro->dropFactor;
+  }
+  if (!due)
+    return;
+
+  if (!reorderComponentsMorton(&eng->em, eng->actors, gs->reg.cid_pos,
+                               gs->boundsMin, gs->boundsMax, &eng->frame))
+    return;
+
+  ro->sortedGap = measureStorageLocality(&eng->em, eng->actors,
+                                         gs->reg.cid_pos, samples);
+  ro->ticks = 0;
+  ro->reorders++;
+}
+
+void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt) {
+  BoidsFrame_t f;
+  if (!BoidsFrameBegin(&f, gs, eng))
+    return;
+
+  BoidsGridBuild(&f, eng);
+  BoidsLodSelect(&f, gs, eng);
+  BoidsAccumulate(&f, gs, eng, dt);
+  BoidsIntegrate(&f, gs, eng, dt);
+  BoidsGridMigrate(&f);
+
+  BoidsFrameEnd(&f);
 }
 
 void SysBoidsDraw(GameState_t *gs, Engine_t *eng) {
@@ -310,19 +678,19 @@ void SysBoidsDraw(GameState_t *gs, Engine_t *eng) {
   // }
 
   // Batched direction lines (1 draw call-ish in rlgl batching terms)
-  rlBegin(RL_LINES);
-  for (int i = 0; i < MAX_ENTITIES; i++) {
-    if (!eng->em.alive[i])
-      continue;
+  // Walks the columns in storage order rather than resolving handles
+  const Vector3 *pos = (const Vector3 *)GetComponentArray(ac, gs->reg.cid_pos);
+  const Vector3 *vel = (const Vector3 *)GetComponentArray(ac, gs->reg.cid_vel);
+  const bool *posOcc = ac->componentStore[gs->reg.cid_pos].occupied;
+  const bool *velOcc = ac->componentStore[gs->reg.cid_vel].occupied;
 
-    entity_t ei = MakeEntityID(ET_ACTOR, i);
-    Vector3 *pPtr = (Vector3 *)getComponent(ac, ei, gs->reg.cid_pos);
-    Vector3 *vPtr = (Vector3 *)getComponent(ac, ei, gs->reg.cid_vel);
-    if (!pPtr || !vPtr)
+  rlBegin(RL_LINES);
+  for (int i = 0; i < eng->em.count; i++) {
+    if (!eng->em.alive[i] || !posOcc[i] || !velOcc[i])
       continue;
 
-    Vector3 p = *pPtr;
-    Vector3 v = *vPtr;
+    Vector3 p = pos[i];
+    Vector3 v = vel[i];
 
     float sp2 = v.x * v.x + v.y * v.y + v.z * v.z;
     if (sp2 < 0.000001f)
@@ -1,6 +1,97 @@
 #pragma once
 #include "../engine.h"
 #include "../game.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Largest uniform-grid dimension per axis
+#define BOIDS_GRID_MAX_DIM 64
+
+// Grid kept across frames (incremental mode). Boids are in doubly linked
+// per-cell lists; the integrate pass records which boids changed cell and
+// BoidsIntegrate migrates just those. Any change to what the grid was built
+// for (storage layout, entity count, cell size, bounds) forces a full rebuild.
+typedef struct {
+  int slot;
+  int cell;
+} BoidsGridMove_t;
+
+typedef struct BoidsGrid {
+  int *head;   // BOIDS_GRID_MAX_DIM^3
+  int *next;   // MAX_ENTITIES
+  int *prev;   // MAX_ENTITIES
+  int *cellOf; // MAX_ENTITIES, -1 = not in the grid
+
+  BoidsGridMove_t *moves; // MAX_ENTITIES
+  int moveCount;
+
+  bool valid;
+  uint32_t layoutVersion;
+  int entityCount;
+  float cellSize;
+  Vector3 bmin, bmax;
+  int dimX, dimY, dimZ;
+
+  // Stats: boids migrated last frame, full rebuilds so far
+  int lastMoves;
+  int rebuilds;
+} BoidsGrid_t;
+
+// State shared by the phases of one boids update. Scratch arrays come from
+// the engine frame arena and are released by BoidsFrameEnd.
+typedef struct {
+  Vector3 *pos;
+  Vector3 *vel;
+  ComponentStorage_t *posS;
+  ComponentStorage_t *velS;
+
+  Vector3 bmin, bmax;
+  float cellSize, invCell;
+  int reach; // stencil half-width in cells
+  int dimX, dimY, dimZ;
+  int cellCount;
+
+  int *head;        // cellCount
+  int *nextIdx;     // MAX_ENTITIES
+
+  // Incremental mode: the persistent grid head/nextIdx point into, and
+  // whether it must be rebuilt this frame
+  BoidsGrid_t *grid;
+  bool gridStale;
+  Vector3 *nextVel; // MAX_ENTITIES
+
+  // LOD schedule for this tick (NULL = every boid steers): 0 = dead-reckon,
+  // otherwise how many ticks the new steering covers
+  uint8_t *steer; // MAX_ENTITIES
+
+  int threads; // OpenMP team size for the hot loops
+
+  Arena_t *scratch;
+  size_t scratchMark;
+} BoidsFrame_t;
 
 void SysBoidsUpdate(GameState_t *gs, Engine_t *eng, float dt);
+// Records a kill plus a replacement spawn for every boid touching the
+// terrain (gs->groundKills). Runs in parallel; nothing changes until
+// engine_flush_commands.
+void SysBoidsGroundCollisions(GameState_t *gs, Engine_t *eng);
+// Positions were written outside SysBoidsUpdate; rebuild the grid next update
+void BoidsGridInvalidate(GameState_t *gs);
+// Morton-reorders component storage when gs->reorder says it is due
+void SysBoidsReorder(GameState_t *gs, Engine_t *eng);
 void SysBoidsDraw(GameState_t *gs, Engine_t *eng);
+
+// The phases SysBoidsUpdate runs, exposed so they can be timed in isolation
+bool BoidsFrameBegin(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng);
+void BoidsGridBuild(BoidsFrame_t *f, Engine_t *eng);
+void BoidsLodSelect(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng);
+void BoidsAccumulate(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng,
+                     float dt);
+void BoidsIntegrate(BoidsFrame_t *f, GameState_t *gs, Engine_t *eng, float dt);
+// Incremental grid only: relinks the boids BoidsIntegrate saw change cell
+void BoidsGridMigrate(BoidsFrame_t *f);
+void BoidsFrameEnd(BoidsFrame_t *f);
+
+// Parses "DIST:EVERY,DIST:EVERY,..." (ascending distances; the last DIST may
+// be "inf") into lod->tiers. Leaves lod untouched and returns false on error.
+bool BoidsLodParseTiers(BoidsLod_t *lod, const char *spec);
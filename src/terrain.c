@@ -0,0 +1,390 @@
+#include "terrain.h"
+#include "engine_components.h"
+#include "raylib.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TERRAIN_SEED 1337u
+
+// ------------------------------------------------------------
+// Generation
+// ------------------------------------------------------------
+static float hash2(int x, int z, uint32_t seed) {
+  uint32_t h = (uint32_t)x * 374761393u + (uint32_t)z * 668265263u + seed;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  h ^= h >> 16;
+  return (float)(h & 0xFFFFFF) / (float)0x1000000;
+}
+
+static float valueNoise(float x, float z, uint32_t seed) {
+  int x0 = (int)floorf(x);
+  int z0 = (int)floorf(z);
+  float fx = x - (float)x0;
+  float fz = z - (float)z0;
+  fx = fx * fx * (3.0f - 2.0f * fx);
+  fz = fz * fz * (3.0f - 2.0f * fz);
+
+  float a = hash2(x0, z0, seed);
+  float b = hash2(x0 + 1, z0, seed);
+  float c = hash2(x0, z0 + 1, seed);
+  float d = hash2(x0 + 1, z0 + 1, seed);
+  return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fz;
+}
+
+static void generateHeights01(float *h, int resX, int resZ) {
+  float lo = FLT_MAX, hi = -FLT_MAX;
+
+  for (int z = 0; z < resZ; z++) {
+    for (int x = 0; x < resX; x++) {
+      float freq = 4.0f / (float)resX;
+      float amp = 1.0f;
+      float v = 0.0f;
+      for (int o = 0; o < 5; o++) {
+        v += valueNoise((float)x * freq, (float)z * freq, TERRAIN_SEED + o) *
+             amp;
+        freq *= 2.0f;
+        amp *= 0.5f;
+      }
+      h[z * resX + x] = v;
+      lo = fminf(lo, v);
+      hi = fmaxf(hi, v);
+    }
+  }
+
+  // Normalize and flatten the lowlands a bit
+  float inv = (hi > lo) ? 1.0f / (hi - lo) : 0.0f;
+  for (int i = 0; i < resX * resZ; i++)
+    h[i] = powf((h[i] - lo) * inv, 1.6f);
+}
+
+static bool loadHeights01(float *h, int resX, int resZ, const char *path) {
+  if (!path || !FileExists(path))
+    return false;
+
+  Image img = LoadImage(path);
+  if (!img.data)
+    return false;
+
+  for (int z = 0; z < resZ; z++) {
+    for (int x = 0; x < resX; x++) {
+      Color c = GetImageColor(img, x * img.width / resX, z * img.height / resZ);
+      h[z * resX + x] = (float)c.r / 255.0f;
+    }
+  }
+
+  UnloadImage(img);
+  return true;
+}
+
+// ------------------------------------------------------------
+// Min/max pyramid
+// ------------------------------------------------------------
+static bool buildPyramid(Terrain_t *t, Arena_t *arena) {
+  int w = t->resX - 1;
+  int h = t->resZ - 1;
+
+  t->levels = 0;
+  for (;;) {
+    int L = t->levels;
+    t->mipW[L] = w;
+    t->mipH[L] = h;
+    size_t bytes = sizeof(float) * (size_t)w * (size_t)h;
+    t->mipMin[L] = arena_alloc(arena, bytes, 0);
+    t->mipMax[L] = arena_alloc(arena, bytes, 0);
+    if (!t->mipMin[L] || !t->mipMax[L])
+      return false;
+    t->levels++;
+
+    for (int z = 0; z < h; z++) {
+      for (int x = 0; x < w; x++) {
+        float mn = FLT_MAX, mx = -FLT_MAX;
+        if (L == 0) {
+          // Four corner samples of heightmap cell (x, z)
+          for (int k = 0; k < 4; k++) {
+            float s = t->height[(z + (k >> 1)) * t->resX + x + (k & 1)];
+            mn = fminf(mn, s);
+            mx = fmaxf(mx, s);
+          }
+        } else {
+          int pw = t->mipW[L - 1];
+          int ph = t->mipH[L - 1];
+          for (int k = 0; k < 4; k++) {
+            int sx = x * 2 + (k & 1);
+            int sz = z * 2 + (k >> 1);
+            if (sx >= pw || sz >= ph)
+              continue;
+            mn = fminf(mn, t->mipMin[L - 1][sz * pw + sx]);
+            mx = fmaxf(mx, t->mipMax[L - 1][sz * pw + sx]);
+          }
+        }
+        t->mipMin[L][z * w + x] = mn;
+        t->mipMax[L][z * w + x] = mx;
+      }
+    }
+
+    if ((w == 1 && h == 1) || t->levels == TERRAIN_MAX_LEVELS)
+      break;
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+  }
+  return true;
+}
+
+// Highest terrain point under the xz box. Picks the level whose cells are at
+// least as wide as the box so at most 2x2 cells are read: O(1) per query.
+// Off the terrain the box is clamped to the edge cells, matching
+// TerrainHeightAt, which extends the edge heights outwards.
+static float pyramidMaxOver(const Terrain_t *t, float x0, float z0, float x1,
+                            float z1) {
+  float inv = 1.0f / t->cellSize;
+  float cx0 = (x0 - t->origin.x) * inv;
+  float cx1 = (x1 - t->origin.x) * inv;
+  float cz0 = (z0 - t->origin.z) * inv;
+  float cz1 = (z1 - t->origin.z) * inv;
+
+  const float wMax = (float)(t->mipW[0] - 1);
+  const float hMax = (float)(t->mipH[0] - 1);
+  int ix0 = (int)fminf(fmaxf(cx0, 0.0f), wMax);
+  int iz0 = (int)fminf(fmaxf(cz0, 0.0f), hMax);
+  int ix1 = (int)fminf(fmaxf(cx1, 0.0f), wMax);
+  int iz1 = (int)fminf(fmaxf(cz1, 0.0f), hMax);
+
+  int span = (ix1 - ix0 > iz1 - iz0) ? ix1 - ix0 : iz1 - iz0;
+  int L = 0;
+  while ((1 << L) <= span && L < t->levels - 1)
+    L++;
+
+  int w = t->mipW[L];
+  const float *mx = t->mipMax[L];
+  float best = -FLT_MAX;
+  for (int z = iz0 >> L; z <= (iz1 >> L); z++)
+    for (int x = ix0 >> L; x <= (ix1 >> L); x++)
+      best = fmaxf(best, mx[z * w + x]);
+  return best;
+}
+
+// ------------------------------------------------------------
+// Render model
+// ------------------------------------------------------------
+static void buildModel(Terrain_t *t) {
+  int w = t->resX, h = t->resZ;
+
+  // Heightmap image for the mesh
+  Image hm = {0};
+  hm.data = malloc((size_t)w * (size_t)h);
+  hm.width = w;
+  hm.height = h;
+  hm.mipmaps = 1;
+  hm.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+
+  // Slope-shaded color image as the diffuse texture (no lighting shader)
+  Image tex = {0};
+  tex.data = malloc((size_t)w * (size_t)h * 4);
+  tex.width = w;
+  tex.height = h;
+  tex.mipmaps = 1;
+  tex.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+  if (!hm.data || !tex.data) {
+    free(hm.data);
+    free(tex.data);
+    return;
+  }
+
+  const float lx = 0.45f, ly = 0.8f, lz = 0.4f;
+  for (int z = 0; z < h; z++) {
+    for (int x = 0; x < w; x++) {
+      float y01 = t->height[z * w + x] / t->heightScale;
+      ((uint8_t *)hm.data)[z * w + x] =
+          (uint8_t)fminf(fmaxf(y01 * 255.0f + 0.5f, 0.0f), 255.0f);
+
+      float hl = t->height[z * w + (x > 0 ? x - 1 : x)];
+      float hr = t->height[z * w + (x < w - 1 ? x + 1 : x)];
+      float hd = t->height[(z > 0 ? z - 1 : z) * w + x];
+      float hu = t->height[(z < h - 1 ? z + 1 : z) * w + x];
+      float nx = hl - hr, ny = 2.0f * t->cellSize, nz = hd - hu;
+      float nl = sqrtf(nx * nx + ny * ny + nz * nz);
+      float lit = fmaxf((nx * lx + ny * ly + nz * lz) / nl, 0.0f);
+      float shade = 0.25f + 0.75f * lit;
+
+      // Green lowlands -> brown -> pale peaks
+      float r = 0.20f + 0.45f * y01, g = 0.45f + 0.10f * y01,
+            b = 0.18f + 0.40f * y01 * y01;
+      uint8_t *px = (uint8_t *)tex.data + ((size_t)z * w + x) * 4;
+      px[0] = (uint8_t)(fminf(r * shade, 1.0f) * 255.0f);
+      px[1] = (uint8_t)(fminf(g * shade, 1.0f) * 255.0f);
+      px[2] = (uint8_t)(fminf(b * shade, 1.0f) * 255.0f);
+      px[3] = 255;
+    }
+  }
+
+  Mesh mesh = GenMeshHeightmap(
+      hm, (Vector3){TERRAIN_SIZE, t->heightScale, TERRAIN_SIZE});
+  t->model = LoadModelFromMesh(mesh);
+  t->model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture =
+      LoadTextureFromImage(tex);
+  t->hasModel = true;
+
+  UnloadImage(hm);
+  UnloadImage(tex);
+}
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+bool TerrainInit(Terrain_t *t, Arena_t *arena, const char *path,
+                 Vector3 origin, float heightScale, bool withModel) {
+  memset(t, 0, sizeof(*t));
+  t->resX = HEIGHTMAP_RES_X;
+  t->resZ = HEIGHTMAP_RES_Z;
+  t->origin = origin;
+  t->heightScale = heightScale;
+  // Square terrain: both axes share one sample spacing
+  t->cellSize = (float)TERRAIN_SIZE / (float)(t->resX - 1);
+
+  t->height =
+      arena_alloc(arena, sizeof(float) * (size_t)t->resX * (size_t)t->resZ, 0);
+  if (!t->height)
+    return false;
+
+  if (!loadHeights01(t->height, t->resX, t->resZ, path)) {
+    if (path)
+      TraceLog(LOG_WARNING, "TERRAIN: cannot load %s, generating", path);
+    generateHeights01(t->height, t->resX, t->resZ);
+  }
+
+  for (int i = 0; i < t->resX * t->resZ; i++)
+    t->height[i] *= heightScale;
+
+  if (!buildPyramid(t, arena)) {
+    TerrainShutdown(t);
+    return false;
+  }
+
+  if (withModel)
+    buildModel(t);
+
+  TraceLog(LOG_INFO, "TERRAIN: %dx%d samples, %d pyramid levels, peak %.1f",
+           t->resX, t->resZ, t->levels,
+           t->origin.y + t->mipMax[t->levels - 1][0]);
+  return true;
+}
+
+void TerrainShutdown(Terrain_t *t) {
+  if (t->hasModel)
+    UnloadModel(t->model); // also unloads the diffuse texture
+  memset(t, 0, sizeof(*t));
+}
+
+void TerrainDraw(const Terrain_t *t) {
+  if (t->hasModel)
+    DrawModel(t->model, t->origin, 1.0f, WHITE);
+}
+
+float TerrainHeightAt(const Terrain_t *t, float x, float z) {
+  float fx = (x - t->origin.x) / t->cellSize;
+  float fz = (z - t->origin.z) / t->cellSize;
+  fx = fminf(fmaxf(fx, 0.0f), (float)(t->resX - 1));
+  fz = fminf(fmaxf(fz, 0.0f), (float)(t->resZ - 1));
+
+  int x0 = (int)fx;
+  int z0 = (int)fz;
+  int x1 = x0 < t->resX - 1 ? x0 + 1 : x0;
+  int z1 = z0 < t->resZ - 1 ? z0 + 1 : z0;
+  float tx = fx - (float)x0;
+  float tz = fz - (float)z0;
+
+  const float *hm = t->height;
+  float a = hm[z0 * t->resX + x0];
+  float b = hm[z0 * t->resX + x1];
+  float c = hm[z1 * t->resX + x0];
+  float d = hm[z1 * t->resX + x1];
+  float top = a + (b - a) * tx;
+  float bot = c + (d - c) * tx;
+  return t->origin.y + top + (bot - top) * tz;
+}
+
+// Fraction along p -> p+seg where the boid first drops below
+// surface + clearance, or -1 if it never does.
+static float marchHit(const Terrain_t *t, Vector3 p, Vector3 seg,
+                      float clearance) {
+  float len = sqrtf(seg.x * seg.x + seg.z * seg.z);
+  int steps = (int)ceilf(len / (0.5f * t->cellSize));
+  if (steps < 1)
+    steps = 1;
+  if (steps > 256)
+    steps = 256;
+
+  for (int s = 0; s <= steps; s++) {
+    float f = (float)s / (float)steps;
+    float qx = p.x + seg.x * f;
+    float qy = p.y + seg.y * f;
+    float qz = p.z + seg.z * f;
+    if (qy < TerrainHeightAt(t, qx, qz) + clearance)
+      return f;
+  }
+  return -1.0f;
+}
+
+int TerrainAvoidBatch(const Terrain_t *t, const Vector3 *pos, Vector3 *vel,
+                      const uint8_t *active, int n,
+                      const TerrainAvoidParams_t *prm, float dt,
+                      bool parallel) {
+  const float baseY = t->origin.y;
+  const float clearance = prm->clearance;
+  int marched = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 256) reduction(+ : marched) if (parallel)
+#else
+  (void)parallel;
+#endif
+  for (int i = 0; i < n; i++) {
+    if (active && !active[i])
+      continue;
+
+    Vector3 p = pos[i];
+    Vector3 v = vel[i];
+    Vector3 seg = {v.x * prm->lookahead, v.y * prm->lookahead,
+                   v.z * prm->lookahead};
+
+    // O(1) reject: lowest point of the segment vs the pyramid max under it
+    float segMinY = fminf(p.y, p.y + seg.y);
+    float groundMax =
+        pyramidMaxOver(t, fminf(p.x, p.x + seg.x), fminf(p.z, p.z + seg.z),
+                       fmaxf(p.x, p.x + seg.x), fmaxf(p.z, p.z + seg.z));
+    if (segMinY - clearance > baseY + groundMax)
+      continue;
+
+    marched++;
+    float f = marchHit(t, p, seg, clearance);
+    if (f < 0.0f)
+      continue;
+
+    // Push along the surface normal at the hit, harder the closer it is
+    float hx = p.x + seg.x * f;
+    float hz = p.z + seg.z * f;
+    float e = t->cellSize;
+    Vector3 nrm = {TerrainHeightAt(t, hx - e, hz) - TerrainHeightAt(t, hx + e, hz),
+                   2.0f * e,
+                   TerrainHeightAt(t, hx, hz - e) - TerrainHeightAt(t, hx, hz + e)};
+    float nl = sqrtf(nrm.x * nrm.x + nrm.y * nrm.y + nrm.z * nrm.z);
+    float push = prm->weight * prm->maxForce * (1.0f - f) / nl;
+
+    v.x += nrm.x * push * dt;
+    v.y += nrm.y * push * dt;
+    v.z += nrm.z * push * dt;
+
+    float sp = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+    if (sp > prm->maxSpeed) {
+      float s = prm->maxSpeed / sp;
+      v = (Vector3){v.x * s, v.y * s, v.z * s};
+    }
+    vel[i] = v;
+  }
+
+  return marched;
+}
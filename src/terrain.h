@@ -0,0 +1,74 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "engine_arena.h"
+#include "engine_components.h"
+#include "raylib.h"
+#include <stdbool.h>
+
+// Heightmap terrain (HEIGHTMAP_RES_X x HEIGHTMAP_RES_Z samples spread over
+// TERRAIN_SIZE world units) with a min/max mip pyramid over its cells.
+//
+// Level 0 holds, per heightmap cell, the min/max of its four corner samples
+// (bilinear heights never leave that range). Each level above halves the
+// resolution until a single cell covers everything.
+
+#define TERRAIN_MAX_LEVELS 16
+
+typedef struct {
+  int resX, resZ;  // samples
+  float *height;   // heights above origin.y, resX * resZ
+  Vector3 origin;  // world position of sample (0,0) at height 0
+  float cellSize;  // world units between samples
+  float heightScale;
+
+  int levels;
+  int mipW[TERRAIN_MAX_LEVELS];
+  int mipH[TERRAIN_MAX_LEVELS];
+  float *mipMin[TERRAIN_MAX_LEVELS];
+  float *mipMax[TERRAIN_MAX_LEVELS];
+
+  Model model;
+  bool hasModel;
+} Terrain_t;
+
+typedef struct {
+  float lookahead; // seconds of travel probed ahead of each boid
+  float clearance; // world units boids try to keep above the surface
+  float weight;    // avoidance strength, in units of maxForce
+  float maxForce;
+  float maxSpeed;
+} TerrainAvoidParams_t;
+
+// Loads `path` (grayscale image) if it exists, otherwise generates fractal
+// noise. Heights and the pyramid come out of `arena`. The render model is only
+// built when `withModel` (needs a GL context).
+bool TerrainInit(Terrain_t *t, Arena_t *arena, const char *path,
+                 Vector3 origin, float heightScale, bool withModel);
+
+// Unloads the render model; the height data goes away with the arena
+void TerrainShutdown(Terrain_t *t);
+
+void TerrainDraw(const Terrain_t *t);
+
+// Bilinear height at world (x, z); edges are clamped
+float TerrainHeightAt(const Terrain_t *t, float x, float z);
+
+// Steers velocities away from the ground for a batch of boids.
+// Each boid first gets an O(1) pyramid test over the segment it will cover
+// within `lookahead`; only boids that fail it are ray-marched. Velocities in
+// `vel` are adjusted in place; `active` (may be NULL) skips dead slots.
+// Returns how many boids needed the precise march.
+int TerrainAvoidBatch(const Terrain_t *t, const Vector3 *pos, Vector3 *vel,
+                      const uint8_t *active, int n,
+                      const TerrainAvoidParams_t *prm, float dt,
+                      bool parallel);
+
+// Pushes a position back above the surface if it ended up underground
+static inline void TerrainClampAbove(const Terrain_t *t, Vector3 *p) {
+  float h = TerrainHeightAt(t, p->x, p->z);
+  if (p->y < h)
+    p->y = h;
+}
+
+#endif